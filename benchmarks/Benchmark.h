@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+#include "Voxel/SparseVoxelOctree.h"
+
+/**
+ * Shared setup of the benchmarks. Each benchmark is a small executable that
+ * prints the average time of every case, run them from a Release build.
+ *
+ * Example usage:
+ *
+ *   SparseVoxelOctree tree(Benchmark::CHUNK_SIZE);
+ *   Benchmark::Terrain(tree, 0, 0);
+ *
+ *   Benchmark::Print("build", Benchmark::Time([&]() { ... }, 10));
+ */
+namespace Benchmark {
+
+/**
+ * The side length of a chunk, the same as Raster::VoxelManager.
+ */
+inline constexpr int CHUNK_SIZE = 128;
+
+/**
+ * Builds the chunk from the same layers of stone, dirt, grass & snow as
+ * Raster::VoxelManager::generateChunk(). The height map is made of sines
+ * instead of noise, so every run and every machine uses the same voxels.
+ */
+inline void Terrain(SparseVoxelOctree &tree, int chunkX, int chunkZ) {
+  static constexpr int layers[][3] = {
+      {0, 16, 1}, {16, 24, 2}, {24, 64, 3}, {64, 128, 4}};
+
+  std::vector<VoxelID> voxels(CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE,
+                              EMPTY_VOXEL);
+
+  for (int z = 0; z < CHUNK_SIZE; z++)
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+      const float worldX = static_cast<float>(x + chunkX * CHUNK_SIZE);
+      const float worldZ = static_cast<float>(z + chunkZ * CHUNK_SIZE);
+      const float n = std::sin(worldX * 0.05f) * std::cos(worldZ * 0.07f);
+      const int height = static_cast<int>(
+          std::round((n * 0.8f + 1.0f) * (CHUNK_SIZE / 2)));
+
+      for (const auto &[from, to, voxel] : layers)
+        for (int y = from; y < std::min(height, to); y++)
+          voxels[x + CHUNK_SIZE * (z + CHUNK_SIZE * y)] =
+              static_cast<VoxelID>(voxel);
+    }
+
+  tree.build(voxels.data());
+}
+
+/**
+ * Returns the average milliseconds of one call, after a few calls to warm
+ * the caches up.
+ */
+inline double Time(const std::function<void()> &function, int iterations) {
+  for (int i = 0; i < 3; i++)
+    function();
+
+  const auto start = std::chrono::high_resolution_clock::now();
+
+  for (int i = 0; i < iterations; i++)
+    function();
+
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+
+  return elapsed.count() / iterations;
+}
+
+inline void Print(const char *name, double milliseconds) {
+  std::printf("%-48s %10.3f ms\n", name, milliseconds);
+}
+
+} // namespace Benchmark
@@ -0,0 +1,110 @@
+#include "Benchmark.h"
+
+#include "Voxel/LinearOctree.h"
+
+/**
+ * Times tracing a view of a 128³ terrain chunk one ray at a time and in
+ * packets of SparseVoxelOctree::PACKET_SIZE, the way
+ * RaytracerCPU::VoxelManager traces every row of the screen in 8×1 tiles.
+ * Both the pointer tree and it's frozen LinearOctree are traced. Build with
+ * and without ENABLE_AVX256 to compare the packet path with the lane by lane
+ * fallback.
+ */
+int main() {
+  using Benchmark::CHUNK_SIZE;
+
+  static constexpr int WIDTH = 512;
+  static constexpr int HEIGHT = 256;
+  static constexpr int PACKET_SIZE = SparseVoxelOctree::PACKET_SIZE;
+
+  static_assert(WIDTH % PACKET_SIZE == 0, "Every row is whole packets");
+
+  SparseVoxelOctree tree(CHUNK_SIZE);
+  Benchmark::Terrain(tree, 0, 0);
+
+  const LinearOctree frozen = tree.freeze();
+
+  /**
+   * A pinhole camera on one edge of the chunk above the terrain, looking
+   * across it and down at it, so rays hit near, far and not at all.
+   */
+  const glm::vec3 origin(64.0f, 120.0f, 0.5f);
+
+  std::vector<glm::vec3> directions(WIDTH * HEIGHT);
+
+  for (int y = 0; y < HEIGHT; y++)
+    for (int x = 0; x < WIDTH; x++) {
+      const float u = (x + 0.5f) / WIDTH * 2.0f - 1.0f;
+      const float v = (y + 0.5f) / HEIGHT * 2.0f - 1.0f;
+      directions[x + y * WIDTH] =
+          glm::normalize(glm::vec3(u * 1.2f, v * 0.6f - 0.5f, 1.0f));
+    }
+
+  /**
+   * Summed so the traces are not optimized away.
+   */
+  volatile uint64_t sink = 0;
+
+  auto traceScalar = [&](auto &traced) {
+    return Benchmark::Time(
+        [&]() {
+          uint64_t sum = 0;
+          RayHit hit;
+
+          for (const glm::vec3 &direction : directions)
+            if (traced.rayTrace(origin, direction, hit))
+              sum += hit.voxel;
+
+          sink = sink + sum;
+        },
+        10);
+  };
+
+  auto tracePackets = [&](auto &traced) {
+    return Benchmark::Time(
+        [&]() {
+          uint64_t sum = 0;
+          glm::vec3 tile[PACKET_SIZE];
+          RayHit hits[PACKET_SIZE];
+
+          for (size_t i = 0; i < directions.size(); i += PACKET_SIZE) {
+            std::copy(&directions[i], &directions[i] + PACKET_SIZE, tile);
+
+            uint8_t lanes = traced.rayTrace(origin, tile, 0xFF, hits);
+
+            for (int lane = 0; lanes; lane++, lanes >>= 1)
+              if (lanes & 1)
+                sum += hits[lane].voxel;
+          }
+
+          sink = sink + sum;
+        },
+        10);
+  };
+
+  const double scalar = traceScalar(tree);
+  const double packet = tracePackets(tree);
+  const double frozenScalar = traceScalar(frozen);
+  const double frozenPacket = tracePackets(frozen);
+
+  const double rays = static_cast<double>(WIDTH) * HEIGHT;
+
+  std::printf("%dx%d rays per run\n", WIDTH, HEIGHT);
+  Benchmark::Print("rayTrace() one ray at a time", scalar);
+  Benchmark::Print("rayTrace() in packets", packet);
+  std::printf("%-48s %10.2f\n", "Mrays/s one ray at a time",
+              rays / scalar / 1e3);
+  std::printf("%-48s %10.2f\n", "Mrays/s in packets", rays / packet / 1e3);
+
+  std::printf("%zu pointer nodes in %zu KiB, %zu frozen nodes in %zu KiB\n",
+              tree.getNodeCount(), tree.getTotalMemoryUsage() / 1024,
+              frozen.getNodeCount(), frozen.getTotalMemoryUsage() / 1024);
+  Benchmark::Print("frozen rayTrace() one ray at a time", frozenScalar);
+  Benchmark::Print("frozen rayTrace() in packets", frozenPacket);
+  std::printf("%-48s %10.2f\n", "frozen Mrays/s one ray at a time",
+              rays / frozenScalar / 1e3);
+  std::printf("%-48s %10.2f\n", "frozen Mrays/s in packets",
+              rays / frozenPacket / 1e3);
+
+  return 0;
+}
@@ -0,0 +1,73 @@
+#include "Benchmark.h"
+
+#include "Voxel/GreedyMesh.h"
+
+/**
+ * Times SparseVoxelOctree::get() the way the meshers use it: every position
+ * of a chunk plus the one voxel wide shell around it, which is looked up in
+ * the neighbours. Then meshes the chunk one material at a time, the path
+ * that calls get() the most.
+ */
+int main() {
+  using Benchmark::CHUNK_SIZE;
+
+  std::unordered_map<glm::ivec3, SparseVoxelOctree *> chunks;
+
+  for (int x = -1; x <= 1; x++) {
+    chunks[{x, 0, 0}] = new SparseVoxelOctree(CHUNK_SIZE);
+    Benchmark::Terrain(*chunks[{x, 0, 0}], x, 0);
+  }
+
+  SparseVoxelOctree *tree = chunks[{0, 0, 0}];
+  tree->setNeighbours({0, 0, 0}, chunks);
+
+  /**
+   * Summed so the lookups are not optimized away.
+   */
+  volatile uint64_t sink = 0;
+
+  const double get = Benchmark::Time(
+      [&]() {
+        uint64_t sum = 0;
+
+        for (int y = -1; y <= CHUNK_SIZE; y++)
+          for (int z = -1; z <= CHUNK_SIZE; z++)
+            for (int x = -1; x <= CHUNK_SIZE; x++)
+              if (Node *node = tree->get(x, y, z))
+                sum += node->voxel;
+
+        sink = sink + sum;
+      },
+      10);
+
+  const long calls = static_cast<long>(CHUNK_SIZE + 2) * (CHUNK_SIZE + 2) *
+                     (CHUNK_SIZE + 2);
+
+  std::printf("%ld get() calls per run\n", calls);
+  Benchmark::Print("get() over the chunk and it's shell", get);
+
+  /**
+   * Every 64³ region of the chunk, one material at a time.
+   */
+  std::vector<PackedQuad> quads;
+  auto context = std::make_unique<GreedyMesh64::Context>();
+
+  const double mesh = Benchmark::Time(
+      [&]() {
+        for (int region = 0; region < 8; region++)
+          for (VoxelID voxel = 1; voxel <= 4; voxel++) {
+            quads.clear();
+            GreedyMesh64::Octree(*context, tree, quads, (region & 1) * 64,
+                                 ((region >> 1) & 1) * 64,
+                                 ((region >> 2) & 1) * 64, voxel);
+          }
+      },
+      10);
+
+  Benchmark::Print("GreedyMesh64::Octree per material, one chunk", mesh);
+
+  for (auto &[coord, chunk] : chunks)
+    delete chunk;
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+#include "Frustum.h"
+
+#ifdef ENABLE_AVX256
+#include <immintrin.h>
+#endif
+
+void AABBList::clear() {
+  minX.clear();
+  minY.clear();
+  minZ.clear();
+  maxX.clear();
+  maxY.clear();
+  maxZ.clear();
+}
+
+void AABBList::push(const glm::vec3 &min, const glm::vec3 &max) {
+  minX.push_back(min.x);
+  minY.push_back(min.y);
+  minZ.push_back(min.z);
+  maxX.push_back(max.x);
+  maxY.push_back(max.y);
+  maxZ.push_back(max.z);
+}
+
+size_t AABBList::size() const { return minX.size(); }
+
+Frustum::Frustum(const glm::mat4 &viewProjection) {
+  /**
+   * Gribb & Hartmann, each plane is the last row of the matrix plus or minus
+   * one of the others. glm is column major, row i is m[0][i] .. m[3][i].
+   */
+  auto row = [&](int i) {
+    return glm::vec4(viewProjection[0][i], viewProjection[1][i],
+                     viewProjection[2][i], viewProjection[3][i]);
+  };
+
+  m_Planes[LEFT] = row(3) + row(0);
+  m_Planes[RIGHT] = row(3) - row(0);
+  m_Planes[BOTTOM] = row(3) + row(1);
+  m_Planes[TOP] = row(3) - row(1);
+  m_Planes[NEAR] = row(3) + row(2);
+  m_Planes[FAR] = row(3) - row(2);
+
+  for (glm::vec4 &plane : m_Planes)
+    plane /= glm::length(glm::vec3(plane));
+}
+
+const glm::vec4 &Frustum::getPlane(Plane plane) const {
+  return m_Planes[plane];
+}
+
+bool Frustum::intersects(const glm::vec3 &min, const glm::vec3 &max) const {
+  /**
+   * Only the corner furthest along the normal has to be tested, if it is
+   * behind the plane the whole box is. Summed in the same order as cull().
+   */
+  for (const glm::vec4 &plane : m_Planes) {
+    const glm::vec3 corner(plane.x > 0.0f ? max.x : min.x,
+                           plane.y > 0.0f ? max.y : min.y,
+                           plane.z > 0.0f ? max.z : min.z);
+
+    if (plane.w + plane.x * corner.x + plane.y * corner.y +
+            plane.z * corner.z <
+        0.0f)
+      return false;
+  }
+
+  return true;
+}
+
+void Frustum::cull(const AABBList &boxes, std::vector<uint8_t> &visible) const {
+  const size_t count = boxes.size();
+  visible.resize(count);
+
+  size_t i = 0;
+
+#ifdef ENABLE_AVX256
+  /**
+   * The planes are the same for every box, so the corner to test is picked
+   * per plane by choosing which array to load from, no blends.
+   */
+  for (; i + 8 <= count; i += 8) {
+    __m256 outside = _mm256_setzero_ps();
+
+    for (const glm::vec4 &plane : m_Planes) {
+      const float *x = plane.x > 0.0f ? &boxes.maxX[i] : &boxes.minX[i];
+      const float *y = plane.y > 0.0f ? &boxes.maxY[i] : &boxes.minY[i];
+      const float *z = plane.z > 0.0f ? &boxes.maxZ[i] : &boxes.minZ[i];
+
+      __m256 distance = _mm256_set1_ps(plane.w);
+      distance = _mm256_add_ps(
+          distance, _mm256_mul_ps(_mm256_set1_ps(plane.x), _mm256_loadu_ps(x)));
+      distance = _mm256_add_ps(
+          distance, _mm256_mul_ps(_mm256_set1_ps(plane.y), _mm256_loadu_ps(y)));
+      distance = _mm256_add_ps(
+          distance, _mm256_mul_ps(_mm256_set1_ps(plane.z), _mm256_loadu_ps(z)));
+
+      outside = _mm256_or_ps(
+          outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+    }
+
+    const int mask = _mm256_movemask_ps(outside);
+
+    for (int b = 0; b < 8; b++)
+      visible[i + b] = !((mask >> b) & 1);
+  }
+#endif
+
+  for (; i < count; i++)
+    visible[i] = intersects({boxes.minX[i], boxes.minY[i], boxes.minZ[i]},
+                            {boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]});
+}
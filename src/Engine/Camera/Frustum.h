@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * Axis aligned boxes in structure of arrays layout, so Frustum::cull() can
+ * load the same coordinate of several boxes at once.
+ */
+struct AABBList {
+  std::vector<float> minX, minY, minZ;
+  std::vector<float> maxX, maxY, maxZ;
+
+  void clear();
+
+  void push(const glm::vec3 &min, const glm::vec3 &max);
+
+  size_t size() const;
+};
+
+/**
+ * The six planes of a view frustum, extracted from a view projection matrix.
+ *
+ * Every plane is (normal, distance) with the normal pointing into the
+ * frustum and normalized, so dot(normal, p) + distance is the signed
+ * distance of p from the plane.
+ *
+ * A box is culled if it is entirely behind any plane. Boxes that straddle
+ * two planes outside a corner of the frustum are kept, the test is
+ * conservative.
+ *
+ * Example usage:
+ *
+ *   Frustum frustum(camera.getViewProjectionMatrix());
+ *
+ *   if (frustum.intersects(min, max))
+ *     ...
+ */
+class Frustum {
+public:
+  enum Plane { LEFT = 0, RIGHT, BOTTOM, TOP, NEAR, FAR };
+
+private:
+  glm::vec4 m_Planes[6] = {};
+
+public:
+  Frustum() = default;
+
+  Frustum(const glm::mat4 &viewProjection);
+
+  const glm::vec4 &getPlane(Plane plane) const;
+
+  /**
+   * Returns true if any part of the box may be inside the frustum.
+   */
+  bool intersects(const glm::vec3 &min, const glm::vec3 &max) const;
+
+  /**
+   * Tests every box of the list, 8 at a time with ENABLE_AVX256.
+   *
+   * @param visible  Resized to the number of boxes, 1 if the box may be
+   * inside the frustum, otherwise 0.
+   */
+  void cull(const AABBList &boxes, std::vector<uint8_t> &visible) const;
+};
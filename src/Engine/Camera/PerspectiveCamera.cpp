@@ -27,6 +27,8 @@ void PerspectiveCamera::update() {
   projection = glm::perspective(glm::radians(fov),
                                 glm::max(viewportWidth / viewportHeight, 1.0f),
                                 nearPlane, farPlane);
+
+  frustum = Frustum(projection * view);
 }
 
 void PerspectiveCamera::setViewportSize(const glm::vec2 &size) {
@@ -100,4 +102,6 @@ const glm::vec3 PerspectiveCamera::getRayDirection(int pixelX,
   // 5. Ray direction = from camera position to world point
   glm::vec3 rayDir = glm::normalize(glm::vec3(worldCoords) - position);
   return rayDir;
-}
\ No newline at end of file
+}
+
+const Frustum &PerspectiveCamera::getFrustum() const { return frustum; }
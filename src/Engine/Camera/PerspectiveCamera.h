@@ -4,6 +4,7 @@
 #include <string>
 
 #include "Camera.h"
+#include "Frustum.h"
 
 class PerspectiveCamera : public Camera {
 private:
@@ -15,6 +16,8 @@ private:
   glm::vec3 up = glm::vec3(0.0f);
   glm::mat4 roll = glm::mat4(0.0f);
 
+  Frustum frustum;
+
 public:
   float viewportWidth = 1.0f;
   float viewportHeight = 1.0f;
@@ -46,4 +49,9 @@ public:
   const glm::mat4 getProjectionMatrix() const override;
   const glm::mat4 getViewMatrix() const override;
   const glm::vec3 getRayDirection(int pixelX, int pixelY) const;
+
+  /**
+   * The planes of the view frustum as of the last update().
+   */
+  const Frustum &getFrustum() const;
 };
\ No newline at end of file
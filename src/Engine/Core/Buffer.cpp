@@ -24,7 +24,7 @@ void Buffer::set(unsigned int chunk, unsigned int count, const void *data,
   if (partitions.size())
     m_Partitions = partitions;
   else
-    m_Partitions.emplace_back(size);
+    m_Partitions = {size};
 
   glBindBuffer((unsigned int)m_Target, m_Buffer);
   glBufferData((unsigned int)m_Target, size, data, (unsigned int)m_Draw);
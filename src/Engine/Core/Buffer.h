@@ -12,6 +12,7 @@ enum class BufferTarget {
   ARRAY_BUFFER = GL_ARRAY_BUFFER,
   ELEMENT_ARRAY_BUFFER = GL_ELEMENT_ARRAY_BUFFER,
   DRAW_INDIRECT_BUFFER = GL_DRAW_INDIRECT_BUFFER,
+  SHADER_STORAGE_BUFFER = GL_SHADER_STORAGE_BUFFER,
 };
 
 struct BufferPartition {
@@ -114,7 +115,7 @@ public:
     if (partitions.size())
       m_Partitions = partitions;
     else
-      m_Partitions.emplace_back(size);
+      m_Partitions = {size};
 
     glBindBuffer((unsigned int)m_Target, m_Buffer);
     glBufferData((unsigned int)m_Target, size, data.data(), (unsigned int)m_Draw);
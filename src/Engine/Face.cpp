@@ -2,13 +2,10 @@
 
 void Face::Top(std::vector<Vertex> &vertices, float px, float py, float pz,
                float sx, float sy, float sz) {
-  vertices.emplace_back(Vertex{px, py + sy, pz, 0, 1, 0});
-  vertices.emplace_back(Vertex{px + sx, py + sy, pz + sz, 0, 1, 0});
-  vertices.emplace_back(Vertex{px + sx, py + sy, pz, 0, 1, 0});
-
   vertices.emplace_back(Vertex{px, py + sy, pz, 0, 1, 0});
   vertices.emplace_back(Vertex{px, py + sy, pz + sz, 0, 1, 0});
   vertices.emplace_back(Vertex{px + sx, py + sy, pz + sz, 0, 1, 0});
+  vertices.emplace_back(Vertex{px + sx, py + sy, pz, 0, 1, 0});
 }
 
 void Face::Bottom(std::vector<Vertex> &vertices, float px, float py, float pz,
@@ -16,21 +13,15 @@ void Face::Bottom(std::vector<Vertex> &vertices, float px, float py, float pz,
   vertices.emplace_back(Vertex{px, py, pz, 0, -1, 0});
   vertices.emplace_back(Vertex{px + sx, py, pz, 0, -1, 0});
   vertices.emplace_back(Vertex{px + sx, py, pz + sz, 0, -1, 0});
-
-  vertices.emplace_back(Vertex{px, py, pz, 0, -1, 0});
-  vertices.emplace_back(Vertex{px + sx, py, pz + sz, 0, -1, 0});
   vertices.emplace_back(Vertex{px, py, pz + sz, 0, -1, 0});
 }
 
 void Face::Front(std::vector<Vertex> &vertices, float px, float py, float pz,
                  float sx, float sy, float sz) {
-  vertices.emplace_back(Vertex{px, py, pz, 0, 0, -1});
-  vertices.emplace_back(Vertex{px + sx, py + sy, pz, 0, 0, -1});
-  vertices.emplace_back(Vertex{px + sx, py, pz, 0, 0, -1});
-
   vertices.emplace_back(Vertex{px, py, pz, 0, 0, -1});
   vertices.emplace_back(Vertex{px, py + sy, pz, 0, 0, -1});
   vertices.emplace_back(Vertex{px + sx, py + sy, pz, 0, 0, -1});
+  vertices.emplace_back(Vertex{px + sx, py, pz, 0, 0, -1});
 }
 
 void Face::Back(std::vector<Vertex> &vertices, float px, float py, float pz,
@@ -38,29 +29,66 @@ void Face::Back(std::vector<Vertex> &vertices, float px, float py, float pz,
   vertices.emplace_back(Vertex{px, py, pz + sz, 0, 0, 1});
   vertices.emplace_back(Vertex{px + sx, py, pz + sz, 0, 0, 1});
   vertices.emplace_back(Vertex{px + sx, py + sy, pz + sz, 0, 0, 1});
-
-  vertices.emplace_back(Vertex{px, py, pz + sz, 0, 0, 1});
-  vertices.emplace_back(Vertex{px + sx, py + sy, pz + sz, 0, 0, 1});
   vertices.emplace_back(Vertex{px, py + sy, pz + sz, 0, 0, 1});
 }
+
 void Face::Left(std::vector<Vertex> &vertices, float px, float py, float pz,
                 float sx, float sy, float sz) {
   vertices.emplace_back(Vertex{px, py, pz, -1, 0, 0});
   vertices.emplace_back(Vertex{px, py, pz + sz, -1, 0, 0});
   vertices.emplace_back(Vertex{px, py + sy, pz + sz, -1, 0, 0});
-
-  vertices.emplace_back(Vertex{px, py, pz, -1, 0, 0});
-  vertices.emplace_back(Vertex{px, py + sy, pz + sz, -1, 0, 0});
   vertices.emplace_back(Vertex{px, py + sy, pz, -1, 0, 0});
 }
 
 void Face::Right(std::vector<Vertex> &vertices, float px, float py, float pz,
                  float sx, float sy, float sz) {
   vertices.emplace_back(Vertex{px + sx, py, pz, 1, 0, 0});
+  vertices.emplace_back(Vertex{px + sx, py + sy, pz, 1, 0, 0});
   vertices.emplace_back(Vertex{px + sx, py + sy, pz + sz, 1, 0, 0});
   vertices.emplace_back(Vertex{px + sx, py, pz + sz, 1, 0, 0});
+}
 
-  vertices.emplace_back(Vertex{px + sx, py, pz, 1, 0, 0});
-  vertices.emplace_back(Vertex{px + sx, py + sy, pz, 1, 0, 0});
-  vertices.emplace_back(Vertex{px + sx, py + sy, pz + sz, 1, 0, 0});
+PackedQuad::PackedQuad(int x, int y, int z, FaceType face, int width,
+                       int height)
+    : position(static_cast<uint32_t>(x) | (static_cast<uint32_t>(y) << 7) |
+               (static_cast<uint32_t>(z) << 14) |
+               (static_cast<uint32_t>(face) << 21)),
+      extent(static_cast<uint32_t>(width - 1) |
+             (static_cast<uint32_t>(height - 1) << 7)) {}
+
+void PackedQuad::setVoxel(uint16_t voxel) {
+  extent = (extent & 0xFFFF) | (static_cast<uint32_t>(voxel) << 16);
+}
+
+void Face::Top(std::vector<PackedQuad> &quads, int px, int py, int pz, int sx,
+               int sy, int sz) {
+  quads.emplace_back(px, py + sy - 1, pz, FaceType::TOP, sx, sz);
+}
+
+void Face::Bottom(std::vector<PackedQuad> &quads, int px, int py, int pz,
+                  int sx, int sy, int sz) {
+  (void)sy;
+  quads.emplace_back(px, py, pz, FaceType::BOTTOM, sx, sz);
+}
+
+void Face::Left(std::vector<PackedQuad> &quads, int px, int py, int pz, int sx,
+                int sy, int sz) {
+  (void)sx;
+  quads.emplace_back(px, py, pz, FaceType::LEFT, sy, sz);
+}
+
+void Face::Right(std::vector<PackedQuad> &quads, int px, int py, int pz,
+                 int sx, int sy, int sz) {
+  quads.emplace_back(px + sx - 1, py, pz, FaceType::RIGHT, sy, sz);
+}
+
+void Face::Front(std::vector<PackedQuad> &quads, int px, int py, int pz,
+                 int sx, int sy, int sz) {
+  (void)sz;
+  quads.emplace_back(px, py, pz, FaceType::FRONT, sx, sy);
+}
+
+void Face::Back(std::vector<PackedQuad> &quads, int px, int py, int pz, int sx,
+                int sy, int sz) {
+  quads.emplace_back(px, py, pz + sz - 1, FaceType::BACK, sx, sy);
 }
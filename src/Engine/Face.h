@@ -1,13 +1,45 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include "Types.h"
 
 enum class FaceType : uint8_t { TOP, BOTTOM, LEFT, RIGHT, FRONT, BACK };
 
+/**
+ * A quad packed into two 32 bit words, 8 bytes instead of four 32 byte
+ * vertices. It is drawn as an instance, raster.vs rebuilds the corners from
+ * gl_VertexID.
+ *
+ *   position  x 0-6 | y 7-13 | z 14-20 | face 21-23
+ *   extent    width - 1 0-6 | height - 1 7-13 | palette id 16-31
+ *
+ * x, y, z is the voxel at the min corner of the quad, local to the chunk.
+ * Width and height are measured along the two axes the face spans, x & z for
+ * top/bottom, y & z for left/right and x & y for front/back.
+ */
+struct PackedQuad {
+  uint32_t position = 0;
+  uint32_t extent = 0;
+
+  PackedQuad() = default;
+  PackedQuad(int x, int y, int z, FaceType face, int width, int height);
+
+  void setVoxel(uint16_t voxel);
+};
+
+/**
+ * Pushes the faces of a box.
+ *
+ * Every face is a quad of 4 corners, in order around the quad. Two triangles
+ * are drawn from them with QUAD_INDICES, so a face costs 4 vertices instead
+ * of 6. The corners of quad i start at vertex 4 * i.
+ */
 class Face {
 public:
+  static constexpr unsigned int QUAD_INDICES[6] = {0, 1, 2, 0, 2, 3};
+
   static void Top(std::vector<Vertex> &vertices, float px, float py, float pz,
                   float sx, float sy, float sz);
   static void Bottom(std::vector<Vertex> &vertices, float px, float py,
@@ -20,4 +52,21 @@ public:
                     float sx, float sy, float sz);
   static void Back(std::vector<Vertex> &vertices, float px, float py, float pz,
                    float sx, float sy, float sz);
+
+  /**
+   * Same as above, except one PackedQuad is pushed for the face of the box at
+   * (px, py, pz) with size (sx, sy, sz).
+   */
+  static void Top(std::vector<PackedQuad> &quads, int px, int py, int pz,
+                  int sx, int sy, int sz);
+  static void Bottom(std::vector<PackedQuad> &quads, int px, int py, int pz,
+                     int sx, int sy, int sz);
+  static void Left(std::vector<PackedQuad> &quads, int px, int py, int pz,
+                   int sx, int sy, int sz);
+  static void Right(std::vector<PackedQuad> &quads, int px, int py, int pz,
+                    int sx, int sy, int sz);
+  static void Front(std::vector<PackedQuad> &quads, int px, int py, int pz,
+                    int sx, int sy, int sz);
+  static void Back(std::vector<PackedQuad> &quads, int px, int py, int pz,
+                   int sx, int sy, int sz);
 };
\ No newline at end of file
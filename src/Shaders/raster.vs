@@ -1,32 +1,77 @@
-#version 330 core
+#version 450 core
+#extension GL_ARB_shader_draw_parameters : require
 
 out vec3 f_Position;
 out vec3 f_Normal;
 out vec4 f_Color;
 flat out int f_MaterialIndex;
 
-layout(location=0)in vec3 in_Position;
-layout(location=1)in vec3 in_Normal;
-layout(location=2)in int in_Color;
-layout(location=3)in int in_MaterialIndex;
+// One packed quad per instance, see PackedQuad in Engine/Face.h
+layout(location=0)in uint in_Position;
+layout(location=1)in uint in_Extent;
 
 uniform mat4 u_View;
 uniform mat4 u_Projection;
 
-vec4 decodeRGBA(int packedColor) {
-  float a = float((packedColor >> 24) & 0xFF) / 255.0;
-  float b = float((packedColor >> 16) & 0xFF) / 255.0;
-  float g = float((packedColor >> 8) & 0xFF) / 255.0;
-  float r = float(packedColor & 0xFF) / 255.0;
-  return vec4(r, g, b, a);
-}
+// The origin of the chunk of every draw command and in w the size of a
+// cell of it's level of detail, see DrawCommands
+layout(std430,binding=0)readonly buffer ChunkOffsets{
+  ivec4 chunkOffsets[];
+};
+
+// The color of every palette id, one texel each
+uniform sampler2D colorPalette;
+
+// Face order matches FaceType: top, bottom, left, right, front, back
+const vec3 NORMALS[6]=vec3[6](
+  vec3(0.,1.,0.),vec3(0.,-1.,0.),vec3(-1.,0.,0.),
+  vec3(1.,0.,0.),vec3(0.,0.,-1.),vec3(0.,0.,1.)
+);
+
+// The axes the width & height of each face are measured along
+const vec3 WIDTH_AXES[6]=vec3[6](
+  vec3(1.,0.,0.),vec3(1.,0.,0.),vec3(0.,1.,0.),
+  vec3(0.,1.,0.),vec3(1.,0.,0.),vec3(1.,0.,0.)
+);
+const vec3 HEIGHT_AXES[6]=vec3[6](
+  vec3(0.,0.,1.),vec3(0.,0.,1.),vec3(0.,0.,1.),
+  vec3(0.,0.,1.),vec3(0.,1.,0.),vec3(0.,1.,0.)
+);
+
+// The corners of each face in order around the quad, drawn with the quad
+// indices 0 1 2 0 2 3, same winding as Face.cpp
+const vec2 CORNERS[24]=vec2[24](
+  vec2(0,0),vec2(0,1),vec2(1,1),vec2(1,0),
+  vec2(0,0),vec2(1,0),vec2(1,1),vec2(0,1),
+  vec2(0,0),vec2(0,1),vec2(1,1),vec2(1,0),
+  vec2(0,0),vec2(1,0),vec2(1,1),vec2(0,1),
+  vec2(0,0),vec2(0,1),vec2(1,1),vec2(1,0),
+  vec2(0,0),vec2(1,0),vec2(1,1),vec2(0,1)
+);
 
 void main()
-{ 
-  f_Normal=in_Normal;
-  f_Position=in_Position;
-  f_Color=decodeRGBA(in_Color);
-  f_MaterialIndex=in_MaterialIndex;
+{
+  int face=int((in_Position>>21u)&7u);
+  int voxel=int(in_Extent>>16u);
+
+  vec3 origin=vec3(in_Position&127u,(in_Position>>7u)&127u,
+    (in_Position>>14u)&127u);
+  vec2 size=vec2((in_Extent&127u)+1u,((in_Extent>>7u)&127u)+1u);
+  vec2 corner=CORNERS[face*4+gl_VertexID]*size;
+
+  ivec4 chunk=chunkOffsets[gl_DrawIDARB];
+
+  // Faces pointing along +x, +y or +z sit on the far side of the voxel
+  vec3 position=origin+max(NORMALS[face],0.)+
+    WIDTH_AXES[face]*corner.x+HEIGHT_AXES[face]*corner.y;
+
+  // Coarse chunks are meshed in cells instead of voxels
+  position=position*float(chunk.w)+vec3(chunk.xyz);
+
+  f_Normal=NORMALS[face];
+  f_Position=position;
+  f_Color=texelFetch(colorPalette,ivec2(voxel,0),0);
+  f_MaterialIndex=voxel;
   
-  gl_Position=u_Projection*u_View*vec4(in_Position,1.);
-}
\ No newline at end of file
+  gl_Position=u_Projection*u_View*vec4(position,1.);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+/**
+ * A thread safe pool of reusable scratch objects.
+ *
+ * Objects are made on demand when every one is in use and are never freed
+ * until the pool is destroyed, so once the pool has grown to the peak number
+ * of users, acquiring does not allocate. Useful for state that would be
+ * thread_local if the threads using it lived long enough to reuse it.
+ *
+ * Example usage:
+ *
+ *   ScratchPool<Context> pool;
+ *
+ *   Context *context = pool.acquire();
+ *   ...
+ *   pool.release(context);
+ */
+template <typename T> class ScratchPool {
+private:
+  std::mutex m_Mutex;
+  std::vector<T *> m_Idle;
+
+public:
+  ScratchPool() = default;
+  ScratchPool(const ScratchPool &) = delete;
+  ScratchPool &operator=(const ScratchPool &) = delete;
+
+  ~ScratchPool() {
+    for (T *object : m_Idle)
+      delete object;
+  }
+
+  /**
+   * Takes an idle object from the pool, or makes one if every one is in use.
+   * Give it back with release().
+   */
+  T *acquire() {
+    std::lock_guard lock(m_Mutex);
+
+    if (m_Idle.empty())
+      return new T();
+
+    T *object = m_Idle.back();
+    m_Idle.pop_back();
+
+    return object;
+  }
+
+  void release(T *object) {
+    std::lock_guard lock(m_Mutex);
+    m_Idle.push_back(object);
+  }
+};
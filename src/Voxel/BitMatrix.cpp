@@ -0,0 +1,251 @@
+#include "BitMatrix.h"
+
+#ifdef ENABLE_AVX256
+#include <immintrin.h>
+#endif
+
+/**
+ * The low j bits of every 2j bits, the columns a round moves.
+ */
+template <typename T> static constexpr T BlockMask(unsigned int j) {
+  T mask = 0;
+  for (unsigned int i = 0; i < sizeof(T) * 8; i += 2 * j)
+    mask |= ((T(1) << j) - 1) << i;
+  return mask;
+}
+
+template <typename T, unsigned int N>
+static inline void TransposeRounds(T (&m)[N], unsigned int first) {
+  for (unsigned int j = first; j != 0; j >>= 1) {
+    const T mask = BlockMask<T>(j);
+
+    for (unsigned int k = 0; k < N; k = ((k | j) + 1) & ~j) {
+      const T t = ((m[k] >> j) ^ m[k | j]) & mask;
+      m[k] ^= t << j;
+      m[k | j] ^= t;
+    }
+  }
+}
+
+void BitMatrix::TransposeScalar(uint64_t (&matrix)[64]) {
+  TransposeRounds(matrix, 32);
+}
+
+void BitMatrix::TransposeScalar(uint32_t (&matrix)[32]) {
+  TransposeRounds(matrix, 16);
+}
+
+void BitMatrix::TransposeScalar(uint128_t (&matrix)[128]) {
+  TransposeRounds(matrix, 64);
+}
+
+#ifdef ENABLE_AVX256
+/**
+ * One round on two registers, row i of lo pairs with row i of hi.
+ */
+template <int Bits>
+static inline void Swap(__m256i &lo, __m256i &hi, unsigned int j,
+                        __m256i mask) {
+  const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(j));
+
+  if constexpr (Bits == 64) {
+    const __m256i t = _mm256_and_si256(
+        _mm256_xor_si256(_mm256_srl_epi64(lo, shift), hi), mask);
+    lo = _mm256_xor_si256(lo, _mm256_sll_epi64(t, shift));
+    hi = _mm256_xor_si256(hi, t);
+  } else {
+    const __m256i t = _mm256_and_si256(
+        _mm256_xor_si256(_mm256_srl_epi32(lo, shift), hi), mask);
+    lo = _mm256_xor_si256(lo, _mm256_sll_epi32(t, shift));
+    hi = _mm256_xor_si256(hi, t);
+  }
+}
+
+/**
+ * The rounds where row k pairs with row k + j in another register, j is at
+ * least the number of rows in a register.
+ */
+template <int Bits, typename T, unsigned int N>
+static inline void TransposeWideRounds(T (&m)[N], unsigned int last) {
+  constexpr unsigned int lanes = 256 / Bits;
+
+  for (unsigned int j = N / 2; j >= last; j >>= 1) {
+    const __m256i mask =
+        Bits == 64 ? _mm256_set1_epi64x(static_cast<int64_t>(BlockMask<T>(j)))
+                   : _mm256_set1_epi32(static_cast<int32_t>(BlockMask<T>(j)));
+
+    for (unsigned int base = 0; base < N; base += 2 * j)
+      for (unsigned int k = base; k < base + j; k += lanes) {
+        __m256i *a = reinterpret_cast<__m256i *>(&m[k]);
+        __m256i *b = reinterpret_cast<__m256i *>(&m[k + j]);
+
+        __m256i lo = _mm256_loadu_si256(a);
+        __m256i hi = _mm256_loadu_si256(b);
+
+        Swap<Bits>(lo, hi, j, mask);
+
+        _mm256_storeu_si256(a, lo);
+        _mm256_storeu_si256(b, hi);
+      }
+  }
+}
+#endif
+
+void BitMatrix::Transpose(uint64_t (&m)[64]) {
+#ifdef ENABLE_AVX256
+  TransposeWideRounds<64>(m, 4);
+
+  const __m256i mask2 = _mm256_set1_epi64x(BlockMask<uint64_t>(2));
+  const __m256i mask1 = _mm256_set1_epi64x(BlockMask<uint64_t>(1));
+
+  /**
+   * Rows k and k + 2, then k and k + 1, are inside the same register. Every
+   * 8 rows are split so each pair lines up across two registers:
+   *
+   *   j = 2  lo = 0 1 4 5  hi = 2 3 6 7  (128 bit halves)
+   *   j = 1  lo = 0 4 2 6  hi = 1 5 3 7  (64 bit unpack)
+   */
+  for (unsigned int g = 0; g < 64; g += 8) {
+    __m256i *a = reinterpret_cast<__m256i *>(&m[g]);
+    __m256i *b = reinterpret_cast<__m256i *>(&m[g + 4]);
+
+    __m256i v0 = _mm256_loadu_si256(a);
+    __m256i v1 = _mm256_loadu_si256(b);
+
+    __m256i lo = _mm256_permute2x128_si256(v0, v1, 0x20);
+    __m256i hi = _mm256_permute2x128_si256(v0, v1, 0x31);
+    Swap<64>(lo, hi, 2, mask2);
+    v0 = _mm256_permute2x128_si256(lo, hi, 0x20);
+    v1 = _mm256_permute2x128_si256(lo, hi, 0x31);
+
+    lo = _mm256_unpacklo_epi64(v0, v1);
+    hi = _mm256_unpackhi_epi64(v0, v1);
+    Swap<64>(lo, hi, 1, mask1);
+    v0 = _mm256_unpacklo_epi64(lo, hi);
+    v1 = _mm256_unpackhi_epi64(lo, hi);
+
+    _mm256_storeu_si256(a, v0);
+    _mm256_storeu_si256(b, v1);
+  }
+#else
+  TransposeScalar(m);
+#endif
+}
+
+void BitMatrix::Transpose(uint32_t (&m)[32]) {
+#ifdef ENABLE_AVX256
+  TransposeWideRounds<32>(m, 8);
+
+  const __m256i mask4 = _mm256_set1_epi32(BlockMask<uint32_t>(4));
+  const __m256i mask2 = _mm256_set1_epi32(BlockMask<uint32_t>(2));
+  const __m256i mask1 = _mm256_set1_epi32(BlockMask<uint32_t>(1));
+
+  /**
+   * Same as the 64 bit transpose with 16 rows per pair of registers and one
+   * more round inside a register:
+   *
+   *   j = 4  lo = 0-3 8-11        hi = 4-7 12-15  (128 bit halves)
+   *   j = 2  lo = 0 1 8 9 ...     hi = 2 3 10 11 ...  (64 bit unpack)
+   *   j = 1  lo = 0 2 8 10 ...    hi = 1 3 9 11 ...   (32 bit shuffle)
+   */
+  for (unsigned int g = 0; g < 32; g += 16) {
+    __m256i *a = reinterpret_cast<__m256i *>(&m[g]);
+    __m256i *b = reinterpret_cast<__m256i *>(&m[g + 8]);
+
+    __m256i v0 = _mm256_loadu_si256(a);
+    __m256i v1 = _mm256_loadu_si256(b);
+
+    __m256i lo = _mm256_permute2x128_si256(v0, v1, 0x20);
+    __m256i hi = _mm256_permute2x128_si256(v0, v1, 0x31);
+    Swap<32>(lo, hi, 4, mask4);
+    v0 = _mm256_permute2x128_si256(lo, hi, 0x20);
+    v1 = _mm256_permute2x128_si256(lo, hi, 0x31);
+
+    lo = _mm256_unpacklo_epi64(v0, v1);
+    hi = _mm256_unpackhi_epi64(v0, v1);
+    Swap<32>(lo, hi, 2, mask2);
+    v0 = _mm256_unpacklo_epi64(lo, hi);
+    v1 = _mm256_unpackhi_epi64(lo, hi);
+
+    lo = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(v0),
+                                               _mm256_castsi256_ps(v1),
+                                               _MM_SHUFFLE(2, 0, 2, 0)));
+    hi = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(v0),
+                                               _mm256_castsi256_ps(v1),
+                                               _MM_SHUFFLE(3, 1, 3, 1)));
+    Swap<32>(lo, hi, 1, mask1);
+    v0 = _mm256_unpacklo_epi32(lo, hi);
+    v1 = _mm256_unpackhi_epi32(lo, hi);
+
+    _mm256_storeu_si256(a, v0);
+    _mm256_storeu_si256(b, v1);
+  }
+#else
+  TransposeScalar(m);
+#endif
+}
+
+void BitMatrix::Transpose(uint128_t (&m)[128]) {
+  /**
+   * blocks[0] and blocks[1] are the low and high halves of rows 0 to 63,
+   * blocks[2] and blocks[3] of rows 64 to 127.
+   */
+  alignas(32) uint64_t blocks[4][64];
+
+  for (unsigned int r = 0; r < 64; r++) {
+    blocks[0][r] = static_cast<uint64_t>(m[r]);
+    blocks[1][r] = static_cast<uint64_t>(m[r] >> 64);
+    blocks[2][r] = static_cast<uint64_t>(m[r + 64]);
+    blocks[3][r] = static_cast<uint64_t>(m[r + 64] >> 64);
+  }
+
+  for (uint64_t(&block)[64] : blocks)
+    Transpose(block);
+
+  for (unsigned int c = 0; c < 64; c++) {
+    m[c] = blocks[0][c] | (static_cast<uint128_t>(blocks[2][c]) << 64);
+    m[c + 64] = blocks[1][c] | (static_cast<uint128_t>(blocks[3][c]) << 64);
+  }
+}
+
+template <typename T>
+void BitMatrix::RowsToAxes(const T *rows, T *columns, T *layers) {
+  constexpr unsigned int N = sizeof(T) * 8;
+
+  alignas(32) T block[N];
+
+  for (unsigned int z = 0; z < N; z++) {
+    T any = 0;
+    for (unsigned int y = 0; y < N; y++)
+      any |= block[y] = rows[y + N * z];
+
+    if (!any)
+      continue;
+
+    Transpose(block);
+
+    for (unsigned int x = 0; x < N; x++)
+      columns[x + N * z] |= block[x];
+  }
+
+  for (unsigned int y = 0; y < N; y++) {
+    T any = 0;
+    for (unsigned int z = 0; z < N; z++)
+      any |= block[z] = rows[y + N * z];
+
+    if (!any)
+      continue;
+
+    Transpose(block);
+
+    for (unsigned int x = 0; x < N; x++)
+      layers[y + N * x] |= block[x];
+  }
+}
+
+template void BitMatrix::RowsToAxes<uint32_t>(const uint32_t *, uint32_t *,
+                                              uint32_t *);
+template void BitMatrix::RowsToAxes<uint64_t>(const uint64_t *, uint64_t *,
+                                              uint64_t *);
+template void BitMatrix::RowsToAxes<uint128_t>(const uint128_t *, uint128_t *,
+                                               uint128_t *);
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * One line of a 128 wide region, two 64 bit words.
+ */
+using uint128_t = unsigned __int128;
+
+/**
+ * Transposes of square bit matrices stored one word per row, bit c of word r
+ * is the element at row r, column c. After a transpose bit r of word c holds
+ * what was bit c of word r.
+ *
+ * A transpose is log2(N) rounds, round j swaps the top right and bottom left
+ * j×j blocks of every 2j×2j block (Hacker's Delight 7-3). With ENABLE_AVX256
+ * every round works on 4 (64 bit) or 8 (32 bit) rows at a time, rows that
+ * pair up inside one register are split into two registers with shuffles
+ * first.
+ *
+ * Example usage:
+ *
+ *   alignas(32) uint64_t matrix[64];
+ *   ...
+ *   BitMatrix::Transpose(matrix);
+ */
+class BitMatrix {
+public:
+  static void Transpose(uint64_t (&matrix)[64]);
+  static void Transpose(uint32_t (&matrix)[32]);
+
+  /**
+   * Transposes the four 64×64 blocks and swaps the two off the diagonal.
+   */
+  static void Transpose(uint128_t (&matrix)[128]);
+
+  /**
+   * The transposes without ENABLE_AVX256.
+   */
+  static void TransposeScalar(uint64_t (&matrix)[64]);
+  static void TransposeScalar(uint32_t (&matrix)[32]);
+  static void TransposeScalar(uint128_t (&matrix)[128]);
+
+  /**
+   * Turns on the bits of the column and layer masks of an N×N×N region from
+   * it's row masks, N is the number of bits in T. See
+   * SparseVoxelOctree::getRegionMasks() for the layouts.
+   *
+   * Every z slice of the columns is the transpose of the same slice of the
+   * rows, every y slice of the layers is the transpose of the rows at that y.
+   * Empty slices are skipped.
+   */
+  template <typename T>
+  static void RowsToAxes(const T *rows, T *columns, T *layers);
+};
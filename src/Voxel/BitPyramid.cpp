@@ -0,0 +1,230 @@
+#include "BitPyramid.h"
+
+#include <cmath>
+
+#ifdef ENABLE_AVX256
+#include <immintrin.h>
+#endif
+
+/**
+ * A pattern of n ones followed by n zeros, repeated over the whole word.
+ */
+static constexpr uint64_t Pattern(int n) {
+  uint64_t pattern = 0;
+  for (int i = 0; i < 64; i += 2 * n)
+    pattern |= ((1ULL << n) - 1) << i;
+  return pattern;
+}
+
+static constexpr uint64_t COMPACT_MASKS[6] = {Pattern(1),  Pattern(2),
+                                              Pattern(4),  Pattern(8),
+                                              Pattern(16), Pattern(32)};
+
+/**
+ * Moves the even bits of the word into the low 32 bits, in order.
+ */
+static inline uint64_t CompactEvenBits(uint64_t bits) {
+  bits &= COMPACT_MASKS[0];
+  for (int i = 0; i < 5; i++)
+    bits = (bits | (bits >> (1 << i))) & COMPACT_MASKS[i + 1];
+  return bits;
+}
+
+void BitPyramid::ReducePairs(const uint64_t *full, const uint64_t *any,
+                             uint64_t *outFull, uint64_t *outAny,
+                             size_t bits) {
+  const size_t words = (bits + 63) / 64;
+  size_t i = 0;
+
+#ifdef ENABLE_AVX256
+  __m256i masks[6];
+  for (int m = 0; m < 6; m++)
+    masks[m] = _mm256_set1_epi64x(static_cast<int64_t>(COMPACT_MASKS[m]));
+
+  const __m256i lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+  auto compact = [&](__m256i v) {
+    v = _mm256_and_si256(v, masks[0]);
+    for (int m = 0; m < 5; m++)
+      v = _mm256_and_si256(
+          _mm256_or_si256(
+              v, _mm256_srl_epi64(v, _mm_cvtsi32_si128(1 << m))),
+          masks[m + 1]);
+
+    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(v, lowHalves));
+  };
+
+  for (; i + 4 <= words; i += 4) {
+    __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&full[i]));
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&any[i]));
+
+    f = _mm256_and_si256(f, _mm256_srli_epi64(f, 1));
+    a = _mm256_or_si256(a, _mm256_srli_epi64(a, 1));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&outFull[i / 2]),
+                     compact(f));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&outAny[i / 2]), compact(a));
+  }
+#endif
+
+  for (; i < words; i++) {
+    const int shift = (i & 1) * 32;
+
+    if (!shift) {
+      outFull[i / 2] = 0;
+      outAny[i / 2] = 0;
+    }
+
+    outFull[i / 2] |= CompactEvenBits(full[i] & (full[i] >> 1)) << shift;
+    outAny[i / 2] |= CompactEvenBits(any[i] | (any[i] >> 1)) << shift;
+  }
+}
+
+void BitPyramid::ReduceBlocks(const uint64_t *full, const uint64_t *any,
+                              uint64_t *outFull, uint64_t *outAny, size_t bits,
+                              size_t block) {
+  if (block < 64) {
+    /**
+     * Several blocks share a word. Reduce every even block with the odd block
+     * above it, then squeeze the even blocks together. Same as CompactEvenBits
+     * except it starts with groups of `block` bits.
+     */
+    const int first = static_cast<int>(std::log2(block));
+    const size_t words = (bits + 63) / 64;
+
+    for (size_t i = 0; i < words; i++) {
+      uint64_t f = full[i] & (full[i] >> block);
+      uint64_t a = any[i] | (any[i] >> block);
+
+      f &= COMPACT_MASKS[first];
+      a &= COMPACT_MASKS[first];
+
+      for (int m = first; m < 5; m++) {
+        f = (f | (f >> (1 << m))) & COMPACT_MASKS[m + 1];
+        a = (a | (a >> (1 << m))) & COMPACT_MASKS[m + 1];
+      }
+
+      const int shift = (i & 1) * 32;
+
+      if (!shift) {
+        outFull[i / 2] = 0;
+        outAny[i / 2] = 0;
+      }
+
+      outFull[i / 2] |= f << shift;
+      outAny[i / 2] |= a << shift;
+    }
+
+    return;
+  }
+
+  /**
+   * Blocks are whole words, block i of the output is an AND/OR of two word
+   * ranges.
+   */
+  const size_t blockWords = block / 64;
+  const size_t pairs = bits / (2 * block);
+
+  for (size_t p = 0; p < pairs; p++) {
+    const uint64_t *f0 = full + (2 * p) * blockWords;
+    const uint64_t *f1 = f0 + blockWords;
+    const uint64_t *a0 = any + (2 * p) * blockWords;
+    const uint64_t *a1 = a0 + blockWords;
+
+    uint64_t *of = outFull + p * blockWords;
+    uint64_t *oa = outAny + p * blockWords;
+
+    size_t i = 0;
+
+#ifdef ENABLE_AVX256
+    for (; i + 4 <= blockWords; i += 4) {
+      auto load = [](const uint64_t *words) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words));
+      };
+
+      const __m256i vf0 = load(&f0[i]), vf1 = load(&f1[i]);
+      const __m256i va0 = load(&a0[i]), va1 = load(&a1[i]);
+
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(of + i),
+                          _mm256_and_si256(vf0, vf1));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(oa + i),
+                          _mm256_or_si256(va0, va1));
+    }
+#endif
+
+    for (; i < blockWords; i++) {
+      of[i] = f0[i] & f1[i];
+      oa[i] = a0[i] | a1[i];
+    }
+  }
+}
+
+void BitPyramid::build(const uint64_t *mask, int size) {
+  m_Size = size;
+  m_Depth = static_cast<int>(std::log2(size));
+  m_Mask = mask;
+
+  m_Full.resize(m_Depth + 1);
+  m_Any.resize(m_Depth + 1);
+
+  const size_t maxWords = (static_cast<size_t>(size) * size * size + 63) / 64;
+
+  for (int i = 0; i < 2; i++) {
+    m_ScratchFull[i].resize(maxWords / 2 + 1);
+    m_ScratchAny[i].resize(maxWords / 2 + 1);
+  }
+
+  const uint64_t *full = mask;
+  const uint64_t *any = mask;
+
+  for (int depth = 1; depth <= m_Depth; depth++) {
+    const size_t below = static_cast<size_t>(size >> (depth - 1));
+    const size_t side = below / 2;
+
+    const size_t bits = below * below * below;
+
+    m_Full[depth].resize((side * side * side + 63) / 64);
+    m_Any[depth].resize((side * side * side + 63) / 64);
+
+    /**
+     * (x, z, y) of `below` → (x/2, z, y)
+     */
+    ReducePairs(full, any, m_ScratchFull[0].data(), m_ScratchAny[0].data(),
+                bits);
+
+    /**
+     * (x/2, z, y) → (x/2, z/2, y), a pair of z neighbours are adjacent rows.
+     */
+    ReduceBlocks(m_ScratchFull[0].data(), m_ScratchAny[0].data(),
+                 m_ScratchFull[1].data(), m_ScratchAny[1].data(), bits / 2,
+                 side);
+
+    /**
+     * (x/2, z/2, y) → (x/2, z/2, y/2), a pair of y neighbours are adjacent
+     * slices.
+     */
+    ReduceBlocks(m_ScratchFull[1].data(), m_ScratchAny[1].data(),
+                 m_Full[depth].data(), m_Any[depth].data(), bits / 4,
+                 side * side);
+
+    full = m_Full[depth].data();
+    any = m_Any[depth].data();
+  }
+}
+
+int BitPyramid::getDepth() const { return m_Depth; }
+
+bool BitPyramid::test(const uint64_t *level, int depth, int x, int y,
+                      int z) const {
+  const size_t side = static_cast<size_t>(m_Size >> depth);
+  const size_t index = x + side * (z + side * y);
+  return (level[index / 64] >> (index % 64)) & 1;
+}
+
+bool BitPyramid::isFull(int depth, int x, int y, int z) const {
+  return test(depth ? m_Full[depth].data() : m_Mask, depth, x, y, z);
+}
+
+bool BitPyramid::isAny(int depth, int x, int y, int z) const {
+  return test(depth ? m_Any[depth].data() : m_Mask, depth, x, y, z);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Full/any summaries of a cubic bitmask, one level per octree depth.
+ *
+ * Level 0 is the mask itself, every level above halves the side length. A bit
+ * at level k summarises the 2^k × 2^k × 2^k block of the mask below it:
+ *
+ *   full  - every bit of the block is on.
+ *   any   - at least one bit of the block is on.
+ *
+ * Every level uses the same flattened layout as the mask, x + s * (z + s * y)
+ * where s is the side length of that level. A level is built from the one
+ * below it by pairing x, then z, then y neighbours with AND (full) and OR
+ * (any). Pairs along z and y are whole rows and slices, so they reduce to
+ * word operations (4 words at a time with ENABLE_AVX256). Pairs along x are
+ * adjacent bits, they are reduced with a shift and compacted with a fixed
+ * sequence of shifts and masks.
+ *
+ * Example usage:
+ *
+ *   BitPyramid pyramid;
+ *   pyramid.build(mask, 128);
+ *
+ *   if (pyramid.isFull(3, 0, 0, 0)) // The 8×8×8 block at the origin is solid
+ *     ...
+ */
+class BitPyramid {
+private:
+  /**
+   * The side length of level 0.
+   */
+  int m_Size = 0;
+
+  /**
+   * log2(m_Size), the index of the top level which is a single bit.
+   */
+  int m_Depth = 0;
+
+  /**
+   * Level 0, not owned.
+   */
+  const uint64_t *m_Mask = nullptr;
+
+  /**
+   * Levels 1 to m_Depth of each pyramid. Index 0 is unused, level 0 is
+   * m_Mask for both. The vectors are kept between builds so rebuilding does
+   * not allocate.
+   */
+  std::vector<std::vector<uint64_t>> m_Full;
+  std::vector<std::vector<uint64_t>> m_Any;
+
+  /**
+   * Scratch buffers for the intermediate x and z reductions.
+   */
+  std::vector<uint64_t> m_ScratchFull[2];
+  std::vector<uint64_t> m_ScratchAny[2];
+
+  /**
+   * Reduces pairs of adjacent bits, bit i of the output is
+   * in[2i] op in[2i + 1].
+   *
+   * @param bits  The number of bits in the input.
+   */
+  static void ReducePairs(const uint64_t *full, const uint64_t *any,
+                          uint64_t *outFull, uint64_t *outAny, size_t bits);
+
+  /**
+   * Reduces pairs of adjacent blocks of `block` bits, block i of the output is
+   * in[2i] op in[2i + 1].
+   *
+   * @param bits   The number of bits in the input.
+   * @param block  The size of a block in bits, a power of two.
+   */
+  static void ReduceBlocks(const uint64_t *full, const uint64_t *any,
+                           uint64_t *outFull, uint64_t *outAny, size_t bits,
+                           size_t block);
+
+  bool test(const uint64_t *level, int depth, int x, int y, int z) const;
+
+public:
+  /**
+   * Builds every level of the pyramid from the mask.
+   * The mask is not copied and must outlive any query.
+   *
+   * @param mask  A bitmask in the layout x + size * (z + size * y).
+   * @param size  The side length of the mask, a power of two.
+   */
+  void build(const uint64_t *mask, int size);
+
+  /**
+   * Returns the index of the top level, log2(size).
+   */
+  int getDepth() const;
+
+  /**
+   * Returns true if every bit of the block at the given level is on.
+   *
+   * @param depth  The level to query, the block covers 2^depth bits per side.
+   * @param x,y,z  The position of the block in that level's coordinates.
+   */
+  bool isFull(int depth, int x, int y, int z) const;
+
+  /**
+   * Returns true if any bit of the block at the given level is on.
+   *
+   * @param depth  The level to query, the block covers 2^depth bits per side.
+   * @param x,y,z  The position of the block in that level's coordinates.
+   */
+  bool isAny(int depth, int x, int y, int z) const;
+};
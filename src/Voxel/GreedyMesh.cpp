@@ -0,0 +1,509 @@
+#include "GreedyMesh.h"
+
+#include <algorithm>
+#include <type_traits>
+
+template <int N>
+void GreedyMesh<N>::SetWidthHeight(uint8_t a, uint8_t b, Mask bits,
+                                   Mask (&widthMasks)[],
+                                   Mask (&heightMasks)[]) {
+  while (bits) {
+    const uint8_t w = Ctz(bits);
+
+    const unsigned int wi = a + (CHUNK_SIZE * (w + (CHUNK_SIZE * b)));
+    widthMasks[wi / CHUNK_SIZE] |= (Mask(1) << (wi % CHUNK_SIZE));
+
+    const unsigned int hi = b + (CHUNK_SIZE * (w + (CHUNK_SIZE * a)));
+    heightMasks[hi / CHUNK_SIZE] |= (Mask(1) << (hi % CHUNK_SIZE));
+
+    bits = ClearLowestBits(bits, w + 1);
+  }
+}
+
+template <int N>
+void GreedyMesh<N>::PrepareWidthHeightMasks(const Mask (&bits)[],
+                                            const Mask (&occluders)[],
+                                            const Mask (&before)[CHUNK_SIZE],
+                                            const Mask (&after)[CHUNK_SIZE],
+                                            FaceMasks &start, FaceMasks &end) {
+
+  for (uint8_t a = 0; a < CHUNK_SIZE; a++)
+    for (uint8_t b = 0; b < CHUNK_SIZE; b++) {
+
+      unsigned int i = a + (CHUNK_SIZE * b);
+
+      /**
+       * The voxels we are meshing, and every solid voxel that can hide their
+       * faces. For a single material both are the same mask.
+       */
+      const Mask mask = bits[i];
+      const Mask occluder = occluders[i];
+
+      /**
+       * Remove all the bits other than the start face
+       * 11100111100011 => 00100000100001
+       */
+      Mask startMask = mask & ~(occluder << 1);
+
+      /**
+       * Likewise remove all the bits other than the end face
+       * 11100111100011 => 10000100000010
+       */
+      Mask endMask = mask & ~(occluder >> 1);
+
+      /**
+       * If the voxel before bit 0 (in the previous neighbour chunk) is solid
+       * turn off bit 0 of the start mask.
+       */
+      startMask &= ~((before[b] >> a) & 1);
+
+      /**
+       * Likewise if the voxel after bit N - 1 (in the next neighbour chunk) is
+       * solid turn off bit N - 1 of the end mask.
+       *
+       * This is done in order to not set the height & width of the face at the
+       * end of the chunk if the neighbour is solid, to avoid creating faces
+       * inbetween chunks.
+       */
+      endMask &= ~(((after[b] >> a) & 1) << (CHUNK_SIZE - 1));
+
+      SetWidthHeight(a, b, startMask, start.width, start.height);
+      SetWidthHeight(a, b, endMask, end.width, end.height);
+    }
+}
+
+template <int N> void GreedyMesh<N>::Clear(FaceMasks &masks) {
+  /**
+   * Zeroed whole, tracking which lines were set cost more in
+   * PrepareWidthHeightMasks() than it saved here.
+   */
+  std::memset(masks.width, 0, sizeof(masks.width));
+  std::memset(masks.height, 0, sizeof(masks.height));
+}
+
+template <int N>
+template <typename T>
+void GreedyMesh<N>::MeshFace(const glm::ivec3 &offsetPosition, uint8_t a,
+                             uint8_t b, Mask bits, Mask (&widthMasks)[],
+                             Mask (&heightMasks)[], std::vector<T> &vertices,
+                             FaceType type) {
+  while (bits) {
+    const uint8_t w = Ctz(bits);
+    bits = ClearLowestBits(bits, w + 1);
+
+    const Mask width = ClearLowestBits(widthMasks[(w + (CHUNK_SIZE * a))], b);
+
+    if (!width)
+      continue;
+
+    const uint8_t widthOffset = Ctz(width);
+
+    uint8_t widthSize =
+        width == ~Mask(0) ? CHUNK_SIZE : Ctz(~(width >> widthOffset));
+
+    const Mask height =
+        ClearLowestBits(heightMasks[w + (CHUNK_SIZE * (int)(widthOffset))], a);
+
+    const uint8_t heightOffset = Ctz(height);
+
+    uint8_t heightSize =
+        height == ~Mask(0) ? CHUNK_SIZE : Ctz(~(height >> heightOffset));
+
+    for (unsigned int i = heightOffset; i < heightOffset + heightSize; i++) {
+      const unsigned int index = w + (CHUNK_SIZE * i);
+
+      const Mask widthSizeMask =
+          (((widthSize >= CHUNK_SIZE ? Mask(0) : (Mask(1) << widthSize)) - 1)
+           << widthOffset);
+
+      const Mask size = widthMasks[index] & widthSizeMask;
+
+      if (size == 0 ||
+          (size != ~Mask(0) && Ctz(~(size >> Ctz(size))) != widthSize)) {
+        heightSize = i - heightOffset;
+        break;
+      }
+
+      widthMasks[index] &= ~widthSizeMask;
+    }
+
+    switch (type) {
+    case FaceType::TOP:
+      Face::Top(vertices, widthOffset + (offsetPosition.x * CHUNK_SIZE),
+                w + (offsetPosition.y * CHUNK_SIZE),
+                a + (offsetPosition.z * CHUNK_SIZE), widthSize, 1.0f,
+                heightSize);
+      break;
+    case FaceType::BOTTOM:
+      Face::Bottom(vertices, widthOffset + (offsetPosition.x * CHUNK_SIZE),
+                   w + (offsetPosition.y * CHUNK_SIZE),
+                   a + (offsetPosition.z * CHUNK_SIZE), widthSize, 1.0f,
+                   heightSize);
+      break;
+
+    case FaceType::LEFT:
+      Face::Left(vertices, w + (offsetPosition.x * CHUNK_SIZE),
+                 widthOffset + (offsetPosition.y * CHUNK_SIZE),
+                 a + (offsetPosition.z * CHUNK_SIZE), 1.0f, widthSize,
+                 heightSize);
+      break;
+    case FaceType::RIGHT:
+      Face::Right(vertices, w + (offsetPosition.x * CHUNK_SIZE),
+                  widthOffset + (offsetPosition.y * CHUNK_SIZE),
+                  a + (offsetPosition.z * CHUNK_SIZE), 1.0f, widthSize,
+                  heightSize);
+
+      break;
+    case FaceType::FRONT:
+      Face::Front(vertices, a + (offsetPosition.x * CHUNK_SIZE),
+                  widthOffset + (offsetPosition.y * CHUNK_SIZE),
+                  w + (offsetPosition.z * CHUNK_SIZE), heightSize, widthSize,
+                  1.0f);
+      break;
+    case FaceType::BACK:
+      Face::Back(vertices, a + (offsetPosition.x * CHUNK_SIZE),
+                 widthOffset + (offsetPosition.y * CHUNK_SIZE),
+                 w + (offsetPosition.z * CHUNK_SIZE), heightSize, widthSize,
+                 1.0f);
+      break;
+    }
+  }
+}
+
+template <int N>
+template <typename T>
+void GreedyMesh<N>::MeshAxis(const glm::ivec3 &offsetPosition,
+                             const Mask (&bits)[], const Mask (&occluders)[],
+                             FaceMasks &start, FaceMasks &end,
+                             std::vector<T> &vertices, FaceType startType,
+                             FaceType endType) {
+  for (uint8_t a = 0; a < CHUNK_SIZE; a++)
+    for (uint8_t b = 0; b < CHUNK_SIZE; b++) {
+      const Mask mask = bits[b + (CHUNK_SIZE * a)];
+      const Mask occluder = occluders[b + (CHUNK_SIZE * a)];
+
+      MeshFace(offsetPosition, a, b, mask & ~(occluder << 1), start.width,
+               start.height, vertices, startType);
+      MeshFace(offsetPosition, a, b, mask & ~(occluder >> 1), end.width,
+               end.height, vertices, endType);
+    }
+}
+
+template <int N>
+size_t GreedyMesh<N>::CountFaces(const AxisMasks &voxels,
+                                 const AxisMasks &occluders) {
+  size_t faces = 0;
+
+  auto count = [&](const Mask(&bits)[], const Mask(&occ)[]) {
+    for (unsigned int i = 0; i < MASK_LENGTH; i++)
+      faces += Popcount(bits[i] & ~(occ[i] << 1)) +
+               Popcount(bits[i] & ~(occ[i] >> 1));
+  };
+
+  count(voxels.rows, occluders.rows);
+  count(voxels.columns, occluders.columns);
+  count(voxels.layers, occluders.layers);
+
+  return faces;
+}
+
+template <int N>
+template <typename T>
+void GreedyMesh<N>::Reserve(std::vector<T> &vertices, size_t faces) {
+  /**
+   * A Vertex face is 4 corners, a PackedQuad is the whole face.
+   */
+  constexpr size_t perFace = std::is_same_v<T, PackedQuad> ? 1 : 4;
+
+  const size_t needed = vertices.size() + faces * perFace;
+
+  if (needed > vertices.capacity())
+    vertices.reserve(std::max(needed, vertices.capacity() * 2));
+}
+
+template <int N>
+template <typename T>
+void GreedyMesh<N>::Mesh(const glm::ivec3 &coord, const AxisMasks &voxels,
+                         const AxisMasks &occluders, Context &context,
+                         std::vector<T> &vertices) {
+  FaceMasks &start = context.start;
+  FaceMasks &end = context.end;
+
+  /**
+   * Culls the column/row/layer
+   * From: 001110110011111
+   * To: 001010110010001
+   *
+   * Loop over the correct axis for each column/row/layer
+   * for columns x,z
+   * for rows    y,z
+   * for layers  y,x
+   *
+   * Set the width and height of each face for both sides (start & end)
+   * for columns bottom & top
+   * for rows    left & right
+   * for layers  front & back
+   *
+   * The masks start out clear and are cleared again after every axis.
+   */
+
+  PrepareWidthHeightMasks(voxels.rows, occluders.rows, context.boundary[0],
+                          context.boundary[1], start, end);
+
+  MeshAxis(coord, voxels.rows, occluders.rows, start, end, vertices,
+           FaceType::LEFT, FaceType::RIGHT);
+
+  Clear(start);
+  Clear(end);
+
+  PrepareWidthHeightMasks(voxels.columns, occluders.columns,
+                          context.boundary[2], context.boundary[3], start,
+                          end);
+
+  MeshAxis(coord, voxels.columns, occluders.columns, start, end, vertices,
+           FaceType::BOTTOM, FaceType::TOP);
+
+  Clear(start);
+  Clear(end);
+
+  PrepareWidthHeightMasks(voxels.layers, occluders.layers,
+                          context.boundary[4], context.boundary[5], start,
+                          end);
+
+  MeshAxis(coord, voxels.layers, occluders.layers, start, end, vertices,
+           FaceType::FRONT, FaceType::BACK);
+
+  Clear(start);
+  Clear(end);
+}
+
+template <int N>
+typename GreedyMesh<N>::Context &GreedyMesh<N>::ThreadContext() {
+  /**
+   * On the heap, the context is too large for the stack of a worker thread
+   * and would make every thread's static TLS block that much larger.
+   */
+  static thread_local std::unique_ptr<Context> context;
+
+  if (!context)
+    context = std::make_unique<Context>();
+
+  return *context;
+}
+
+template <int N>
+template <typename T>
+void GreedyMesh<N>::Octree(SparseVoxelOctree *tree, std::vector<T> &vertices,
+                           int originX, int originY, int originZ,
+                           VoxelID filter) {
+  Octree(ThreadContext(), tree, vertices, originX, originY, originZ, filter);
+}
+
+template <int N>
+template <typename T>
+void GreedyMesh<N>::Octree(SparseVoxelOctree *tree, const Palette &palette,
+                           std::vector<T> &vertices, int originX, int originY,
+                           int originZ, int lod) {
+  Octree(ThreadContext(), tree, palette, vertices, originX, originY, originZ,
+         lod);
+}
+
+template <int N>
+template <typename T>
+void GreedyMesh<N>::Octree(Context &context, SparseVoxelOctree *tree,
+                           std::vector<T> &vertices, int originX, int originY,
+                           int originZ, VoxelID filter) {
+  glm::ivec3 coord = {originX / CHUNK_SIZE, originY / CHUNK_SIZE,
+                      originZ / CHUNK_SIZE};
+
+  /**
+   * Generate the bit mask for rows, columns and layers.
+   *
+   * For columns:
+   *
+   *       At (x, z) you can get the height of the column in one bitwise
+   * operation and you can get the location of all the top & bottom faces in one
+   * bitwise operation y0 y1 y2 y3 z0 x0 0  0  0  0 z0 x1 0  0  0  0 z0 x2 0  0
+   * 0  0 z0 x3 0  0  0  0 z1 x0 0  0  0  0 z1 x1 0  0  0  0 z1 x2 0  0  0  0 z1
+   * x3 0  0  0  0
+   */
+  if (context.voxels.empty())
+    context.voxels.resize(1);
+
+  AxisMasks &voxels = context.voxels[EMPTY_VOXEL];
+  AxisMasks &occluders = context.occluders;
+
+  std::memset(&voxels, 0, sizeof(AxisMasks));
+
+  /**
+   * One walk of the tree fills all three masks, uniform subtrees are written a
+   * row at a time.
+   */
+  if (!tree->getRegionMasks(originX, originY, originZ, filter, voxels.rows,
+                            voxels.columns, voxels.layers))
+    return;
+
+  /**
+   * Every other voxel still hides the faces of the filtered voxel.
+   */
+  const AxisMasks *solid = &voxels;
+
+  if (filter) {
+    std::memset(&occluders, 0, sizeof(AxisMasks));
+    tree->getRegionMasks(originX, originY, originZ, EMPTY_VOXEL,
+                         occluders.rows, occluders.columns, occluders.layers);
+    solid = &occluders;
+  }
+
+  tree->getBoundarySlices(originX, originY, originZ, context.boundary);
+
+  Reserve(vertices, CountFaces(voxels, *solid));
+
+  const size_t first = vertices.size();
+
+  Mesh(coord, voxels, *solid, context, vertices);
+
+  if constexpr (std::is_same_v<T, PackedQuad>)
+    for (size_t i = first; i < vertices.size(); i++)
+      vertices[i].setVoxel(filter);
+}
+
+template <int N>
+template <typename T>
+void GreedyMesh<N>::Octree(Context &context, SparseVoxelOctree *tree,
+                           const Palette &palette, std::vector<T> &vertices,
+                           int originX, int originY, int originZ, int lod) {
+  glm::ivec3 coord = {originX / CHUNK_SIZE, originY / CHUNK_SIZE,
+                      originZ / CHUNK_SIZE};
+
+  /**
+   * One set of masks per palette id, plus every solid voxel regardless of
+   * it's id. Only the masks of ids found in the region are cleared.
+   */
+  std::vector<AxisMasks> &voxels = context.voxels;
+  std::vector<VoxelID> &found = context.found;
+  AxisMasks &occluders = context.occluders;
+
+  if (voxels.size() < palette.size())
+    voxels.resize(palette.size());
+
+  std::memset(&occluders, 0, sizeof(AxisMasks));
+  found.clear();
+
+  auto fill = [&](int x, int y, int z, int size, VoxelID voxel) {
+    AxisMasks &masks = voxels[voxel];
+
+    if (std::find(found.begin(), found.end(), voxel) == found.end()) {
+      found.push_back(voxel);
+      std::memset(&masks, 0, sizeof(AxisMasks));
+    }
+
+    SparseVoxelOctree::FillRegionRows(x, y, z, size, masks.rows);
+    SparseVoxelOctree::FillRegionRows(x, y, z, size, occluders.rows);
+  };
+
+  /**
+   * A coarser level covers N << lod voxels, but no more than the tree. Every
+   * bit of the masks is then a 2^lod wide cell.
+   */
+  if (lod)
+    tree->forEachCell(originX, originY, originZ,
+                      std::min(CHUNK_SIZE << lod, tree->getSize()), 1 << lod,
+                      fill);
+  else
+    tree->forEachLeaf(originX, originY, originZ, CHUNK_SIZE, fill);
+
+  if (found.empty())
+    return;
+
+  /**
+   * Only the rows are filled per leaf, the columns and layers of every mask
+   * are transposed from them once the whole region is known.
+   */
+  for (VoxelID id : found)
+    BitMatrix::RowsToAxes(voxels[id].rows, voxels[id].columns,
+                          voxels[id].layers);
+  BitMatrix::RowsToAxes(occluders.rows, occluders.columns, occluders.layers);
+
+  /**
+   * A coarse region keeps every face on it's border. The neighbours may be
+   * meshed at another level, so the border faces close the seam between them
+   * like a skirt.
+   */
+  if (lod)
+    std::memset(context.boundary, 0, sizeof(context.boundary));
+  else
+    tree->getBoundarySlices(originX, originY, originZ, context.boundary);
+
+  /**
+   * Room for every id is made up front, so meshing them never reallocates.
+   */
+  size_t faces = 0;
+  for (VoxelID id : found)
+    faces += CountFaces(voxels[id], occluders);
+
+  Reserve(vertices, faces);
+
+  for (VoxelID id : found) {
+    const size_t first = vertices.size();
+
+    Mesh(coord, voxels[id], occluders, context, vertices);
+
+    Tag(vertices, first, id, palette.get(id));
+  }
+}
+
+template <int N>
+void GreedyMesh<N>::Tag(std::vector<Vertex> &vertices, size_t first,
+                        VoxelID id, const Voxel &voxel) {
+  (void)id;
+  for (size_t i = first; i < vertices.size(); i++) {
+    vertices[i].color = voxel.color;
+    vertices[i].material = voxel.material;
+  }
+}
+
+template <int N>
+void GreedyMesh<N>::Tag(std::vector<PackedQuad> &quads, size_t first,
+                        VoxelID id, const Voxel &voxel) {
+  (void)voxel;
+  for (size_t i = first; i < quads.size(); i++)
+    quads[i].setVoxel(id);
+}
+
+/**
+ * Every mesher and output type that is used, for each width.
+ */
+#define INSTANTIATE_GREEDY_MESH(N)                                             \
+  template class GreedyMesh<N>;                                                \
+  template void GreedyMesh<N>::Octree(SparseVoxelOctree *,                     \
+                                      std::vector<Vertex> &, int, int, int,    \
+                                      VoxelID);                                \
+  template void GreedyMesh<N>::Octree(SparseVoxelOctree *,                     \
+                                      std::vector<PackedQuad> &, int, int,     \
+                                      int, VoxelID);                           \
+  template void GreedyMesh<N>::Octree(SparseVoxelOctree *, const Palette &,    \
+                                      std::vector<Vertex> &, int, int, int,    \
+                                      int);                                    \
+  template void GreedyMesh<N>::Octree(SparseVoxelOctree *, const Palette &,    \
+                                      std::vector<PackedQuad> &, int, int,     \
+                                      int, int);                               \
+  template void GreedyMesh<N>::Octree(Context &, SparseVoxelOctree *,          \
+                                      std::vector<Vertex> &, int, int, int,    \
+                                      VoxelID);                                \
+  template void GreedyMesh<N>::Octree(Context &, SparseVoxelOctree *,          \
+                                      std::vector<PackedQuad> &, int, int,     \
+                                      int, VoxelID);                           \
+  template void GreedyMesh<N>::Octree(Context &, SparseVoxelOctree *,          \
+                                      const Palette &, std::vector<Vertex> &,  \
+                                      int, int, int, int);                     \
+  template void GreedyMesh<N>::Octree(Context &, SparseVoxelOctree *,          \
+                                      const Palette &,                         \
+                                      std::vector<PackedQuad> &, int, int,     \
+                                      int, int);
+
+INSTANTIATE_GREEDY_MESH(32)
+INSTANTIATE_GREEDY_MESH(64)
+INSTANTIATE_GREEDY_MESH(128)
+
+#undef INSTANTIATE_GREEDY_MESH
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <bitset>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Engine/Face.h"
+#include "Engine/Types.h"
+#include "Voxel/BitMatrix.h"
+#include "Voxel/Palette.h"
+#include "Voxel/SparseVoxelOctree.h"
+
+#ifdef ENABLE_AVX256
+#include <immintrin.h>
+#endif
+
+/**
+ * The word that holds one line of an N wide region.
+ */
+template <int N> struct MaskWord;
+template <> struct MaskWord<32> { using Type = uint32_t; };
+template <> struct MaskWord<64> { using Type = uint64_t; };
+template <> struct MaskWord<128> { using Type = uint128_t; };
+
+/**
+ * Greedy meshes an N×N×N region of a SparseVoxelOctree, N is 32, 64 or 128.
+ *
+ * Every line of the region along an axis is one word, uint32_t, uint64_t or
+ * a pair of 64 bit words for 128, so a 128³ chunk is meshed in one call
+ * without splitting it into sub regions.
+ *
+ * Example usage:
+ *
+ *   GreedyMesh<128>::Octree(tree, palette, quads, 0, 0, 0);
+ */
+template <int N> class GreedyMesh {
+public:
+  using Mask = typename MaskWord<N>::Type;
+
+  static constexpr uint8_t CHUNK_SIZE = N;
+  static constexpr unsigned int MASK_LENGTH = CHUNK_SIZE * CHUNK_SIZE;
+
+  /**
+   * The occupancy of an N³ region along each axis, see
+   * SparseVoxelOctree::getRegionMasks().
+   */
+  struct AxisMasks {
+    alignas(32) Mask rows[MASK_LENGTH];
+    alignas(32) Mask columns[MASK_LENGTH];
+    alignas(32) Mask layers[MASK_LENGTH];
+  };
+
+  /**
+   * The width & height masks of one side of the faces along an axis, see
+   * SetWidthHeight().
+   */
+  struct FaceMasks {
+    alignas(32) Mask width[MASK_LENGTH];
+    alignas(32) Mask height[MASK_LENGTH];
+  };
+
+  /**
+   * Scratch state for meshing, ~230 KiB for N = 64 plus the masks of every
+   * palette id, 8 times that for N = 128. Make one per thread and pass it to
+   * every call, or use the overloads without a context which keep one per
+   * thread. Once warm, meshing with the same context does not allocate and
+   * does not use the stack for masks.
+   *
+   * Example usage:
+   *
+   *   auto context = std::make_unique<GreedyMesh64::Context>();
+   *
+   *   for (...)
+   *     GreedyMesh64::Octree(*context, tree, palette, quads, x, y, z);
+   */
+  struct Context {
+    /**
+     * The masks of every palette id, index EMPTY_VOXEL holds the filtered
+     * voxels of the single material mesher.
+     */
+    std::vector<AxisMasks> voxels;
+
+    /**
+     * The palette ids found in the current region.
+     */
+    std::vector<VoxelID> found;
+
+    /**
+     * Every solid voxel of the region.
+     */
+    AxisMasks occluders;
+
+    /**
+     * The solid voxels just outside each side of the region, see
+     * SparseVoxelOctree::getBoundarySlices().
+     */
+    Mask boundary[6][CHUNK_SIZE];
+
+    /**
+     * Always clear between calls.
+     */
+    FaceMasks start = {};
+    FaceMasks end = {};
+  };
+
+private:
+  /**
+   * The index of the lowest bit that is on, bits must not be zero.
+   */
+  static int Ctz(Mask bits) {
+    if constexpr (N == 128) {
+      const uint64_t low = static_cast<uint64_t>(bits);
+      return low ? __builtin_ctzll(low)
+                 : 64 + __builtin_ctzll(static_cast<uint64_t>(bits >> 64));
+    } else if constexpr (N == 64)
+      return __builtin_ctzll(bits);
+    else
+      return __builtin_ctz(bits);
+  }
+
+  static int Popcount(Mask bits) {
+    if constexpr (N == 128)
+      return __builtin_popcountll(static_cast<uint64_t>(bits)) +
+             __builtin_popcountll(static_cast<uint64_t>(bits >> 64));
+    else if constexpr (N == 64)
+      return __builtin_popcountll(bits);
+    else
+      return __builtin_popcount(bits);
+  }
+
+  static Mask ClearLowestBits(Mask bits, int n) {
+    return (n >= CHUNK_SIZE) ? 0 : (bits & ~((Mask(1) << n) - 1));
+  }
+
+  static void SetWidthHeight(uint8_t a, uint8_t b, Mask bits,
+                             Mask (&widthMasks)[], Mask (&heightMasks)[]);
+
+  /**
+   * Sets the width & height masks of the faces along an axis. Bit a of
+   * before[b] and after[b] is on if the voxel just before bit 0 or just after
+   * bit N - 1 of line a + N * b is solid, which hides the face on that end.
+   */
+  static void PrepareWidthHeightMasks(const Mask (&bits)[],
+                                      const Mask (&occluders)[],
+                                      const Mask (&before)[CHUNK_SIZE],
+                                      const Mask (&after)[CHUNK_SIZE],
+                                      FaceMasks &start, FaceMasks &end);
+
+  /**
+   * Zeroes the masks.
+   */
+  static void Clear(FaceMasks &masks);
+
+  template <typename T>
+  static void MeshFace(const glm::ivec3 &offsetPosition, uint8_t a, uint8_t b,
+                       Mask bits, Mask (&widthMasks)[], Mask (&heightMasks)[],
+                       std::vector<T> &vertices, FaceType type);
+
+  template <typename T>
+  static void MeshAxis(const glm::ivec3 &offsetPosition, const Mask (&bits)[],
+                       const Mask (&occluders)[], FaceMasks &start,
+                       FaceMasks &end, std::vector<T> &vertices,
+                       FaceType startType, FaceType endType);
+
+  /**
+   * Greedy meshes the voxels along all three axes. A face is only made where
+   * the voxel next to it is not in occluders.
+   */
+  template <typename T>
+  static void Mesh(const glm::ivec3 &coord, const AxisMasks &voxels,
+                   const AxisMasks &occluders, Context &context,
+                   std::vector<T> &vertices);
+
+  /**
+   * The context used by the overloads that don't take one, made the first
+   * time a thread meshes.
+   */
+  static Context &ThreadContext();
+
+  /**
+   * Returns an upper bound on the number of faces Mesh() makes, every exposed
+   * voxel face before they are merged.
+   */
+  static size_t CountFaces(const AxisMasks &voxels, const AxisMasks &occluders);
+
+  /**
+   * Makes room for that many more faces so meshing never reallocates. The
+   * capacity at least doubles, a reused vector stops growing once it fits
+   * the largest region.
+   */
+  template <typename T>
+  static void Reserve(std::vector<T> &vertices, size_t faces);
+
+  /**
+   * Tags the vertices from first onwards with the color & material of the
+   * voxel, or the quads with it's palette id.
+   */
+  static void Tag(std::vector<Vertex> &vertices, size_t first, VoxelID id,
+                  const Voxel &voxel);
+  static void Tag(std::vector<PackedQuad> &quads, size_t first, VoxelID id,
+                  const Voxel &voxel);
+
+public:
+  /**
+   * Greedy meshes the N³ region at the origin.
+   *
+   * The output is either Vertex, four per face, or PackedQuad, one per face.
+   * Packed quads are tagged with the filter as their palette id.
+   *
+   * @param filter  Optional filter; if provided only voxels with this palette
+   * id are meshed, every other voxel still hides their faces.
+   */
+  template <typename T>
+  static void Octree(SparseVoxelOctree *tree, std::vector<T> &vertices,
+                     int originX, int originY, int originZ,
+                     VoxelID filter = EMPTY_VOXEL);
+
+  template <typename T>
+  static void Octree(Context &context, SparseVoxelOctree *tree,
+                     std::vector<T> &vertices, int originX, int originY,
+                     int originZ, VoxelID filter = EMPTY_VOXEL);
+
+  /**
+   * Greedy meshes every voxel of the N³ region at the origin in one pass.
+   *
+   * The tree is walked once, building the masks of every palette id found
+   * in the region and the masks of all solid voxels together. The vertices of
+   * each id are tagged with the color and material from the palette, packed
+   * quads are tagged with the id.
+   *
+   * @param lod  Optional level of detail; if provided the region is meshed
+   * from 2^lod wide cells of average voxels, see
+   * SparseVoxelOctree::forEachCell(). The region then covers N << lod voxels
+   * or the whole tree if that is smaller, the output is in cells and every
+   * face on the border of the region is kept.
+   */
+  template <typename T>
+  static void Octree(SparseVoxelOctree *tree, const Palette &palette,
+                     std::vector<T> &vertices, int originX, int originY,
+                     int originZ, int lod = 0);
+
+  template <typename T>
+  static void Octree(Context &context, SparseVoxelOctree *tree,
+                     const Palette &palette, std::vector<T> &vertices,
+                     int originX, int originY, int originZ, int lod = 0);
+};
+
+using GreedyMesh32 = GreedyMesh<32>;
+using GreedyMesh64 = GreedyMesh<64>;
+using GreedyMesh128 = GreedyMesh<128>;
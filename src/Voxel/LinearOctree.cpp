@@ -0,0 +1,125 @@
+#include "LinearOctree.h"
+
+#include <bit>
+#include <cassert>
+
+namespace {
+
+/**
+ * Reads a LinearOctree for OctreeRay, a node is referred to by it's index.
+ */
+struct LinearView {
+  using Ref = uint32_t;
+
+  static constexpr Ref NONE = UINT32_MAX;
+
+  const std::vector<LinearNode> &nodes;
+  int size;
+  int depth;
+
+  Ref getRoot() const { return 0; }
+  int getSize() const { return size; }
+  int getDepth() const { return depth; }
+
+  /**
+   * Only the root can be stored without solid voxels, freeze() drops every
+   * other empty node.
+   */
+  bool isEmpty(Ref node) const {
+    return node == NONE || (!nodes[node].voxel && !nodes[node].childMask);
+  }
+
+  VoxelID getVoxel(Ref node) const { return nodes[node].voxel; }
+
+  Ref getChild(Ref node, int child) const {
+    const LinearNode &parent = nodes[node];
+
+    if (!(parent.childMask & (1 << child)))
+      return NONE;
+
+    return parent.firstChild +
+           std::popcount(
+               static_cast<uint8_t>(parent.childMask & ((1u << child) - 1)));
+  }
+};
+
+} // namespace
+
+LinearOctree::LinearOctree(int size, std::vector<LinearNode> nodes)
+    : m_Size(size), m_Depth(static_cast<uint8_t>(std::countr_zero(
+                        static_cast<unsigned>(size)))),
+      m_Nodes(std::move(nodes)) {
+  assert(std::has_single_bit(static_cast<unsigned>(size)));
+  assert(!m_Nodes.empty());
+}
+
+int LinearOctree::getSize() const { return m_Size; }
+
+int LinearOctree::getDepth() const { return m_Depth; }
+
+size_t LinearOctree::getNodeCount() const { return m_Nodes.size(); }
+
+bool LinearOctree::isEmpty() const {
+  return m_Nodes.empty() || (!m_Nodes[0].voxel && !m_Nodes[0].childMask);
+}
+
+VoxelID LinearOctree::get(int x, int y, int z, VoxelID filter) const {
+  if (m_Nodes.empty() || x < 0 || y < 0 || z < 0 || x >= m_Size ||
+      y >= m_Size || z >= m_Size)
+    return EMPTY_VOXEL;
+
+  uint32_t index = 0;
+
+  for (int shift = m_Depth - 1;; shift--) {
+    const LinearNode &node = m_Nodes[index];
+
+    if (node.voxel) {
+      if (filter && filter != node.voxel)
+        return EMPTY_VOXEL;
+      return node.voxel;
+    }
+
+    if (shift < 0)
+      return EMPTY_VOXEL;
+
+    const int child = (((x >> shift) & 1) << 2) | (((y >> shift) & 1) << 1) |
+                      ((z >> shift) & 1);
+
+    if (!(node.childMask & (1 << child)))
+      return EMPTY_VOXEL;
+
+    index = node.firstChild +
+            std::popcount(
+                static_cast<uint8_t>(node.childMask & ((1u << child) - 1)));
+  }
+}
+
+bool LinearOctree::rayTrace(const glm::vec3 &origin,
+                            const glm::vec3 &direction, RayHit &hit) const {
+  if (m_Nodes.empty()) {
+    hit = {};
+    return false;
+  }
+
+  return OctreeRay::Trace(LinearView{m_Nodes, m_Size, m_Depth}, origin,
+                          direction, hit);
+}
+
+uint8_t LinearOctree::rayTrace(const glm::vec3 &origin,
+                               const glm::vec3 (&directions)[PACKET_SIZE],
+                               uint8_t lanes,
+                               RayHit (&hits)[PACKET_SIZE]) const {
+  if (m_Nodes.empty()) {
+    for (int i = 0; i < PACKET_SIZE; i++)
+      if ((lanes >> i) & 1)
+        hits[i] = {};
+    return 0;
+  }
+
+  return OctreeRay::Trace(LinearView{m_Nodes, m_Size, m_Depth}, origin,
+                          directions, lanes, hits);
+}
+
+size_t LinearOctree::getTotalMemoryUsage() const {
+  return sizeof(LinearOctree) + (m_Nodes.capacity() * sizeof(LinearNode));
+}
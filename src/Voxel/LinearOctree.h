@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Voxel/OctreeRay.h"
+#include "Voxel/Voxel.h"
+
+/**
+ * A single node of the LinearOctree, 8 bytes.
+ *
+ * The children of a node are stored next to each other in the node array, in
+ * child index order, starting at firstChild. Only the children with solid
+ * voxels are stored, so the array index of child i is:
+ *
+ *   firstChild + popcount(childMask & ((1 << i) - 1))
+ */
+struct LinearNode {
+  /**
+   * Index of the first child in the node array.
+   * Only valid if childMask is not zero.
+   */
+  uint32_t firstChild = 0;
+
+  /**
+   * Bit i is on if child i exists.
+   * Child i covers the octant ((i >> 2) & 1, (i >> 1) & 1, i & 1) in x, y, z.
+   */
+  uint8_t childMask = 0;
+
+  /**
+   * The depth of the node, log2 of the size it covers.
+   */
+  uint8_t depth = 0;
+
+  /**
+   * The palette id of the voxel if this node is a leaf, otherwise
+   * EMPTY_VOXEL.
+   */
+  VoxelID voxel = EMPTY_VOXEL;
+};
+
+static_assert(sizeof(LinearNode) == 8, "A LinearNode is 8 bytes");
+
+/**
+ * A pointerless, read only copy of a SparseVoxelOctree.
+ *
+ * All nodes live in one contiguous array, laid out breadth first so siblings
+ * are adjacent. Instead of 8 child pointers every node stores a child bitmask
+ * and the index of it's first child, which makes a node 8 bytes instead of
+ * ~80 bytes, and keeps get() and rayTrace() walking a small block of memory.
+ *
+ * A LinearOctree is frozen from a SparseVoxelOctree once it is done being
+ * edited, see SparseVoxelOctree::freeze(). It does not resolve neighbours,
+ * lookups outside the tree return EMPTY_VOXEL.
+ *
+ * Example usage:
+ *
+ *   SparseVoxelOctree tree(128);
+ *   tree.set(mask, voxel);
+ *
+ *   LinearOctree frozen = tree.freeze();
+ *   VoxelID voxel = frozen.get(x, y, z);
+ */
+class LinearOctree {
+public:
+  static constexpr int PACKET_SIZE = OctreeRay::PACKET_SIZE;
+
+private:
+  /**
+   * The side length of the root node's region, always a power of two.
+   */
+  int m_Size = 0;
+
+  /**
+   * log2(m_Size), the number of subdivisions of the tree.
+   */
+  uint8_t m_Depth = 0;
+
+  /**
+   * The nodes of the tree, the root is always at index 0.
+   */
+  std::vector<LinearNode> m_Nodes;
+
+public:
+  /**
+   * Constructs an empty LinearOctree, every lookup returns EMPTY_VOXEL.
+   */
+  LinearOctree() = default;
+
+  /**
+   * Takes over the nodes of a tree of the given size, laid out as described
+   * in LinearNode with the root at index 0.
+   */
+  LinearOctree(int size, std::vector<LinearNode> nodes);
+
+  /**
+   * Returns the side length of the root node.
+   */
+  int getSize() const;
+
+  /**
+   * Returns log2 of the side length of the root node.
+   */
+  int getDepth() const;
+
+  /**
+   * Returns the number of nodes in the tree.
+   */
+  size_t getNodeCount() const;
+
+  /**
+   * Returns true if there are no solid voxels in the tree.
+   */
+  bool isEmpty() const;
+
+  /**
+   * Returns the palette id of the voxel at the given position.
+   *
+   * @param x, y, z   The position to query, local to this tree.
+   * @param filter    Optional filter; if provided, only voxels with this
+   * palette id are returned.
+   * @return          The palette id at that position, or EMPTY_VOXEL if empty,
+   * out of bounds or filtered out.
+   */
+  VoxelID get(int x, int y, int z, VoxelID filter = EMPTY_VOXEL) const;
+
+  /**
+   * Finds the first voxel hit by the ray inside this tree, the same hit as
+   * SparseVoxelOctree::rayTrace() on the tree this was frozen from.
+   *
+   * @param origin     The origin of the ray, local to this tree.
+   * @param direction  The direction of the ray, need not be normalized.
+   * @param hit        Set to the hit, if there is one.
+   * @return           True if the ray hit a voxel.
+   */
+  bool rayTrace(const glm::vec3 &origin, const glm::vec3 &direction,
+                RayHit &hit) const;
+
+  /**
+   * Traces a packet of rays from the same origin together, see
+   * SparseVoxelOctree::rayTrace().
+   *
+   * @return  The lanes that hit a voxel, bit i is lane i.
+   */
+  uint8_t rayTrace(const glm::vec3 &origin,
+                   const glm::vec3 (&directions)[PACKET_SIZE], uint8_t lanes,
+                   RayHit (&hits)[PACKET_SIZE]) const;
+
+  /**
+   * Returns the total memory usage of the LinearOctree in bytes.
+   */
+  size_t getTotalMemoryUsage() const;
+};
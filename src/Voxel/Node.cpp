@@ -1,59 +1,75 @@
 #include "Node.h"
-#include <unordered_map>
 
 Node::Node() {}
 
 Node::Node(uint8_t depth) : depth(depth) {}
 
-Node::~Node() { clear(); }
-
-bool Node::operator==(const Node &other) const {
-  return voxel->color == other.voxel->color &&
-         voxel->material == other.voxel->material;
-}
+bool Node::operator==(const Node &other) const { return voxel == other.voxel; }
 
 bool Node::operator!=(const Node &other) const { return !(*this == other); }
 
 void Node::clear() {
   depth = 0;
-  voxel = nullptr;
+  voxel = EMPTY_VOXEL;
+  average = EMPTY_VOXEL;
+  count = 0;
 
+  /**
+   * The children are owned by the NodePool of the tree, we only drop the
+   * references here.
+   */
   for (int i = 0; i < 8; i++)
-    if (children[i]) {
-      delete children[i];
-      children[i] = nullptr;
-    }
+    children[i] = nullptr;
 }
 
-Voxel *Node::getAverageVoxel() {
-  Voxel *merged = new Voxel();
+void Node::summarize() {
+  if (voxel) {
+    average = voxel;
+    count = getVolume();
+    return;
+  }
+
+  VoxelID voxels[8];
+  int counts[8];
+  int found = 0;
 
-  std::unordered_map<int, int> color;
-  std::unordered_map<int, int> material;
+  count = 0;
 
-  for (const Node *child : children) {
-    if (!child || !child->voxel)
+  for (Node *child : children) {
+    if (!child || !child->average)
       continue;
 
-    color[child->voxel->color]++;
-    material[child->voxel->material]++;
-  }
+    count += child->count;
 
-  int colorCount = 0;
-  for (const auto &[color, count] : color) {
-    if (count < colorCount)
-      continue;
-    merged->color = color;
-    colorCount = count;
+    int i = 0;
+    while (i < found && voxels[i] != child->average)
+      i++;
+
+    if (i == found) {
+      voxels[found] = child->average;
+      counts[found++] = 0;
+    }
+
+    counts[i]++;
   }
 
-  int materialCount = 0;
-  for (const auto &[material, count] : material) {
-    if (count < materialCount)
+  average = EMPTY_VOXEL;
+  int voxelCount = 0;
+
+  for (int i = 0; i < found; i++) {
+    if (counts[i] <= voxelCount)
       continue;
-    merged->material = material;
-    materialCount = count;
+    average = voxels[i];
+    voxelCount = counts[i];
   }
+}
+
+VoxelID Node::getAverageVoxel() const { return average; }
+
+uint32_t Node::getVoxelCount() const { return count; }
+
+bool Node::isEmpty() const { return !count; }
+
+uint32_t Node::getVolume() const { return 1u << (3 * depth); }
 
-  return merged;
-}
\ No newline at end of file
+bool Node::isSolid() const { return count == getVolume(); }
@@ -3,18 +3,71 @@
 #include <glm/glm.hpp>
 
 struct Node {
+  /**
+   * The deepest tree a node can be in, the voxels under a node at this depth
+   * must fit the count of the summary.
+   */
+  static constexpr uint8_t MAX_DEPTH = 10;
+
+  static_assert(3 * MAX_DEPTH < 32, "count holds 2^(3 * depth) voxels");
+
   uint8_t depth = 0;
-  Voxel *voxel = nullptr;
+  VoxelID voxel = EMPTY_VOXEL;
+
+  /**
+   * A summary of every voxel under the node, see summarize(). The tree keeps
+   * it up to date whenever the node or one of it's children changes, so
+   * reading it never walks the subtree.
+   *
+   *   average  - the most common voxel, see getAverageVoxel().
+   *   count    - the number of solid voxels.
+   */
+  VoxelID average = EMPTY_VOXEL;
+  uint32_t count = 0;
+
   Node *children[8] = {nullptr};
 
   Node();
   Node(uint8_t depth);
-  ~Node();
 
   bool operator==(const Node &other) const;
   bool operator!=(const Node &other) const;
 
   void clear();
 
-  Voxel *getAverageVoxel();
+  /**
+   * Sets the summary from the voxel of a leaf, or from the summaries of the
+   * children, which must already be up to date.
+   */
+  void summarize();
+
+  /**
+   * Returns the most common voxel of the node, the voxel of a leaf.
+   *
+   * Every child votes once, with it's own voxel or, if it is not a leaf, it's
+   * average. Empty children don't vote, so the average is only empty if the
+   * whole node is. Ties go to the lowest child index.
+   */
+  VoxelID getAverageVoxel() const;
+
+  /**
+   * Returns the number of solid voxels under the node.
+   */
+  uint32_t getVoxelCount() const;
+
+  /**
+   * Returns the number of voxels under the node, solid or not.
+   */
+  uint32_t getVolume() const;
+
+  /**
+   * Returns true if there are no solid voxels under the node.
+   */
+  bool isEmpty() const;
+
+  /**
+   * Returns true if every voxel under the node is solid, they may be of
+   * different ids.
+   */
+  bool isSolid() const;
 };
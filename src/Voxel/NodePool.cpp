@@ -0,0 +1,57 @@
+#include "NodePool.h"
+
+NodePool::~NodePool() {
+  for (Node *slab : m_Slabs)
+    delete[] slab;
+}
+
+Node *NodePool::allocate(uint8_t depth) {
+  Node *node = nullptr;
+
+  if (!m_FreeList.empty()) {
+    node = m_FreeList.back();
+    m_FreeList.pop_back();
+  } else {
+    if (m_Cursor == SLAB_SIZE) {
+      m_Slab++;
+      m_Cursor = 0;
+    }
+
+    if (m_Slab == m_Slabs.size())
+      m_Slabs.push_back(new Node[SLAB_SIZE]);
+
+    node = &m_Slabs[m_Slab][m_Cursor++];
+  }
+
+  node->clear();
+  node->depth = depth;
+
+  return node;
+}
+
+void NodePool::release(Node *node) {
+  if (!node)
+    return;
+
+  for (int i = 0; i < 8; i++)
+    release(node->children[i]);
+
+  node->clear();
+  m_FreeList.push_back(node);
+}
+
+void NodePool::reset() {
+  m_Slab = 0;
+  m_Cursor = 0;
+  m_FreeList.clear();
+}
+
+size_t NodePool::getMemoryUsage() const {
+  return (m_Slabs.size() * SLAB_SIZE * sizeof(Node)) +
+         (m_Slabs.capacity() * sizeof(Node *)) +
+         (m_FreeList.capacity() * sizeof(Node *));
+}
+
+size_t NodePool::getNodeCount() const {
+  return (m_Slab * SLAB_SIZE) + m_Cursor - m_FreeList.size();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Voxel/Node.h"
+
+/**
+ * A per-tree arena for octree nodes.
+ *
+ * Nodes are carved out of fixed size slabs instead of being allocated one by
+ * one with new/delete. Nodes released while the tree is being built (for
+ * example when 8 children collapse into their parent) go onto a free list and
+ * are handed out again before the slab cursor advances.
+ *
+ * reset() rewinds the cursor and drops the free list without touching the
+ * nodes, so clearing a tree is O(1) and the slabs are reused when the chunk is
+ * regenerated.
+ *
+ * A pool is not thread safe, it is owned by a single SparseVoxelOctree which
+ * is already guarded by the chunk mutex.
+ */
+class NodePool {
+public:
+  static constexpr size_t SLAB_SIZE = 4096;
+
+private:
+  /**
+   * Every slab is an array of SLAB_SIZE nodes.
+   * Slabs are never freed until the pool is destroyed.
+   */
+  std::vector<Node *> m_Slabs;
+
+  /**
+   * The slab we are currently carving nodes out of.
+   */
+  size_t m_Slab = 0;
+
+  /**
+   * The index of the next unused node in the current slab.
+   */
+  size_t m_Cursor = 0;
+
+  /**
+   * Nodes that were released and can be handed out again.
+   */
+  std::vector<Node *> m_FreeList;
+
+public:
+  NodePool() = default;
+
+  /**
+   * Frees all the slabs.
+   * Every node handed out by this pool is invalid after this.
+   */
+  ~NodePool();
+
+  /**
+   * Disable copy constructor
+   */
+  NodePool(const NodePool &) = delete;
+
+  /**
+   * Disable assignment operator
+   */
+  NodePool &operator=(const NodePool &) = delete;
+
+  /**
+   * Returns a cleared node with the given depth.
+   *
+   * @param depth The depth of the node, log2 of the size it represents.
+   */
+  Node *allocate(uint8_t depth);
+
+  /**
+   * Returns a node and all it's children to the pool.
+   */
+  void release(Node *node);
+
+  /**
+   * Releases every node at once.
+   * The slabs are kept so the next build does not need to allocate.
+   */
+  void reset();
+
+  /**
+   * Returns the memory reserved by the slabs and the free list in bytes.
+   */
+  size_t getMemoryUsage() const;
+
+  /**
+   * Returns the number of nodes handed out and not released.
+   */
+  size_t getNodeCount() const;
+};
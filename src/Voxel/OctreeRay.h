@@ -0,0 +1,425 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Voxel/Voxel.h"
+
+#ifdef ENABLE_AVX256
+#include <immintrin.h>
+#endif
+
+/**
+ * The first voxel hit by a ray, see SparseVoxelOctree::rayTrace().
+ */
+struct RayHit {
+  VoxelID voxel = EMPTY_VOXEL;
+
+  /**
+   * The t of the hit along the ray, origin + distance * direction lies on the
+   * face that was hit. In units of the length of the direction, 0 if the
+   * origin is inside the voxel.
+   */
+  float distance = 0.0f;
+
+  /**
+   * The normal of the face that was hit, zero if the origin is inside the
+   * voxel.
+   */
+  glm::ivec3 normal{0, 0, 0};
+};
+
+/**
+ * The ray traversal of an octree, shared by SparseVoxelOctree and
+ * LinearOctree so both give the same hits.
+ *
+ * The tree is read through a view, a small struct with:
+ *
+ *   Ref     getRoot() const;
+ *   int     getSize() const;
+ *   int     getDepth() const;
+ *   bool    isEmpty(Ref node) const;   // true for a missing node too
+ *   VoxelID getVoxel(Ref node) const;  // EMPTY_VOXEL if not a leaf
+ *   Ref     getChild(Ref node, int child) const;
+ *
+ * Ref is whatever the tree uses to point at a node, a pointer or an index.
+ */
+class OctreeRay {
+public:
+  /**
+   * The number of rays traced together by the packet Trace().
+   */
+  static constexpr int PACKET_SIZE = 8;
+
+private:
+  /**
+   * The child of a node the ray enters first, from the t at which it enters
+   * the node and the t at which it crosses the middle of the node, both in
+   * mirrored space, see Trace().
+   */
+  static int FirstChild(const glm::vec3 &t0, const glm::vec3 &tm) {
+    int child = 0;
+
+    /**
+     * The ray enters through the plane it crosses last, every other axis
+     * whose middle it already crossed by then starts in the far half.
+     */
+    if (t0.x > t0.y && t0.x > t0.z) {
+      if (tm.y < t0.x)
+        child |= 2;
+      if (tm.z < t0.x)
+        child |= 1;
+    } else if (t0.y > t0.z) {
+      if (tm.x < t0.y)
+        child |= 4;
+      if (tm.z < t0.y)
+        child |= 1;
+    } else {
+      if (tm.x < t0.z)
+        child |= 4;
+      if (tm.y < t0.z)
+        child |= 2;
+    }
+
+    return child;
+  }
+
+  /**
+   * The child the ray enters after leaving child through the nearest of it's
+   * exit planes t1, or 8 if the ray leaves the node.
+   */
+  static int NextChild(int child, const glm::vec3 &t1) {
+    if (t1.x < t1.y && t1.x < t1.z)
+      return (child & 4) ? 8 : child | 4;
+
+    if (t1.y < t1.z)
+      return (child & 2) ? 8 : child | 2;
+
+    return (child & 1) ? 8 : child | 1;
+  }
+
+  /**
+   * The AVX2 body of the packet Trace(), every lane's direction must have
+   * the same sign as the others on each axis.
+   */
+  template <typename View>
+  static uint8_t TracePacket(const View &view, const glm::vec3 &origin,
+                             const glm::vec3 (&directions)[PACKET_SIZE],
+                             uint8_t lanes, RayHit (&hits)[PACKET_SIZE]);
+
+public:
+  /**
+   * Finds the first voxel hit by the ray inside the tree of the view, see
+   * SparseVoxelOctree::rayTrace().
+   */
+  template <typename View>
+  static bool Trace(const View &view, const glm::vec3 &origin,
+                    const glm::vec3 &direction, RayHit &hit);
+
+  /**
+   * Traces a packet of rays from the same origin together, see the packet
+   * SparseVoxelOctree::rayTrace().
+   */
+  template <typename View>
+  static uint8_t Trace(const View &view, const glm::vec3 &origin,
+                       const glm::vec3 (&directions)[PACKET_SIZE],
+                       uint8_t lanes, RayHit (&hits)[PACKET_SIZE]);
+};
+
+template <typename View>
+bool OctreeRay::Trace(const View &view, const glm::vec3 &origin,
+                      const glm::vec3 &direction, RayHit &hit) {
+  using Ref = decltype(view.getRoot());
+
+  hit = {};
+
+  if (view.isEmpty(view.getRoot()))
+    return false;
+
+  /**
+   * Mirror the ray so every component of the direction is positive, the
+   * children are then always visited from low to high. mirror flips the
+   * child index back to the real one.
+   *
+   * A component of 0 is nudged so the planes of that axis are crossed at
+   * +/- infinity instead of at NaN.
+   */
+  const float size = static_cast<float>(view.getSize());
+
+  glm::vec3 o = origin;
+  glm::vec3 d = direction;
+  int mirror = 0;
+
+  for (int i = 0; i < 3; i++) {
+    if (d[i] < 0.0f) {
+      o[i] = size - o[i];
+      d[i] = -d[i];
+      mirror |= 4 >> i;
+    }
+
+    d[i] = std::max(d[i], 1e-20f);
+  }
+
+  const glm::vec3 inverseDirection = 1.0f / d;
+
+  /**
+   * The t spans are computed from the corner of each node, which is exact,
+   * rather than halving the parent's span. A ray that runs along a plane
+   * between voxels then stays on the same side of it all the way down.
+   */
+  struct Frame {
+    Ref node;
+    glm::vec3 min, tm;
+    float half;
+    int child;
+  };
+
+  assert(view.getDepth() < 32);
+  Frame stack[32];
+  int top = 0;
+
+  Ref node = view.getRoot();
+  glm::vec3 min(0.0f);
+  float nodeSize = size;
+
+  glm::vec3 t0 = (min - o) * inverseDirection;
+  glm::vec3 t1 = (min + nodeSize - o) * inverseDirection;
+
+  for (;;) {
+    const float tEnter = std::max(std::max(t0.x, t0.y), t0.z);
+    const float tExit = std::min(std::min(t1.x, t1.y), t1.z);
+
+    /**
+     * Only a node the ray passes through in front of the origin is visited,
+     * empty ones are skipped by their summary.
+     */
+    if (tEnter < tExit && tExit > 0.0f && !view.isEmpty(node)) {
+      if (const VoxelID voxel = view.getVoxel(node)) {
+        hit.voxel = voxel;
+        hit.distance = std::max(tEnter, 0.0f);
+
+        if (tEnter > 0.0f) {
+          const int axis = tEnter == t0.x ? 0 : tEnter == t0.y ? 1 : 2;
+          hit.normal[axis] = direction[axis] < 0.0f ? 1 : -1;
+        }
+
+        return true;
+      }
+
+      const float half = nodeSize * 0.5f;
+      const glm::vec3 tm = (min + half - o) * inverseDirection;
+
+      stack[top++] = {node, min, tm, half, FirstChild(t0, tm)};
+    }
+
+    /**
+     * Pick the next child of the deepest node that has one left.
+     */
+    while (top > 0 && stack[top - 1].child == 8)
+      top--;
+
+    if (top == 0)
+      return false;
+
+    Frame &frame = stack[top - 1];
+    const int child = frame.child;
+
+    min = frame.min + glm::vec3((child >> 2) & 1, (child >> 1) & 1, child & 1) *
+                          frame.half;
+    nodeSize = frame.half;
+
+    t0 = (min - o) * inverseDirection;
+    t1 = (min + nodeSize - o) * inverseDirection;
+
+    frame.child = NextChild(child, t1);
+    node = view.getChild(frame.node, child ^ mirror);
+  }
+}
+
+template <typename View>
+uint8_t OctreeRay::Trace(const View &view, const glm::vec3 &origin,
+                         const glm::vec3 (&directions)[PACKET_SIZE],
+                         uint8_t lanes, RayHit (&hits)[PACKET_SIZE]) {
+#ifdef ENABLE_AVX256
+  bool coherent = true;
+
+  for (int axis = 0; axis < 3 && coherent; axis++) {
+    uint8_t negative = 0;
+
+    for (int i = 0; i < PACKET_SIZE; i++)
+      if (directions[i][axis] < 0.0f)
+        negative |= 1 << i;
+
+    negative &= lanes;
+    coherent = !negative || negative == lanes;
+  }
+
+  if (coherent)
+    return TracePacket(view, origin, directions, lanes, hits);
+#endif
+
+  uint8_t hitLanes = 0;
+
+  for (int i = 0; i < PACKET_SIZE; i++)
+    if (((lanes >> i) & 1) && Trace(view, origin, directions[i], hits[i]))
+      hitLanes |= 1 << i;
+
+  return hitLanes;
+}
+
+template <typename View>
+uint8_t OctreeRay::TracePacket(const View &view, const glm::vec3 &origin,
+                               const glm::vec3 (&directions)[PACKET_SIZE],
+                               uint8_t lanes, RayHit (&hits)[PACKET_SIZE]) {
+#ifdef ENABLE_AVX256
+  using Ref = decltype(view.getRoot());
+
+  for (int i = 0; i < PACKET_SIZE; i++)
+    if ((lanes >> i) & 1)
+      hits[i] = {};
+
+  if (!lanes || view.isEmpty(view.getRoot()))
+    return 0;
+
+  /**
+   * Same mirroring as the single ray Trace(), the lanes all head into the
+   * same octant so one mirror and one origin serve them all.
+   */
+  const float size = static_cast<float>(view.getSize());
+  const int lead = __builtin_ctz(lanes);
+
+  glm::vec3 o = origin;
+  int mirror = 0;
+
+  for (int axis = 0; axis < 3; axis++)
+    if (directions[lead][axis] < 0.0f) {
+      o[axis] = size - o[axis];
+      mirror |= 4 >> axis;
+    }
+
+  alignas(32) float inverse[3][PACKET_SIZE];
+
+  for (int axis = 0; axis < 3; axis++)
+    for (int i = 0; i < PACKET_SIZE; i++)
+      inverse[axis][i] =
+          1.0f / std::max(std::abs(directions[i][axis]), 1e-20f);
+
+  const __m256 inverseX = _mm256_load_ps(inverse[0]);
+  const __m256 inverseY = _mm256_load_ps(inverse[1]);
+  const __m256 inverseZ = _mm256_load_ps(inverse[2]);
+  const __m256 zero = _mm256_setzero_ps();
+
+  struct Entry {
+    Ref node;
+    glm::vec3 min;
+    float size;
+    uint8_t lanes;
+  };
+
+  /**
+   * Every node pushes at most 8 children and is popped once.
+   */
+  assert(view.getDepth() < 32);
+  Entry stack[7 * 32 + 1];
+  int top = 0;
+
+  stack[top++] = {view.getRoot(), glm::vec3(0.0f), size, lanes};
+
+  uint8_t done = 0;
+
+  while (top > 0) {
+    const Entry entry = stack[--top];
+    const uint8_t active = entry.lanes & ~done;
+
+    if (!active)
+      continue;
+
+    const glm::vec3 near = entry.min - o;
+    const glm::vec3 far = entry.min + entry.size - o;
+
+    const __m256 t0x = _mm256_mul_ps(_mm256_set1_ps(near.x), inverseX);
+    const __m256 t0y = _mm256_mul_ps(_mm256_set1_ps(near.y), inverseY);
+    const __m256 t0z = _mm256_mul_ps(_mm256_set1_ps(near.z), inverseZ);
+
+    const __m256 tEnter = _mm256_max_ps(_mm256_max_ps(t0x, t0y), t0z);
+    const __m256 tExit = _mm256_min_ps(
+        _mm256_min_ps(_mm256_mul_ps(_mm256_set1_ps(far.x), inverseX),
+                      _mm256_mul_ps(_mm256_set1_ps(far.y), inverseY)),
+        _mm256_mul_ps(_mm256_set1_ps(far.z), inverseZ));
+
+    const uint8_t crossed =
+        active &
+        _mm256_movemask_ps(
+            _mm256_and_ps(_mm256_cmp_ps(tEnter, tExit, _CMP_LT_OQ),
+                          _mm256_cmp_ps(tExit, zero, _CMP_GT_OQ)));
+
+    if (!crossed)
+      continue;
+
+    const Ref node = entry.node;
+    const VoxelID voxel = view.getVoxel(node);
+
+    if (!voxel) {
+      const float half = entry.size * 0.5f;
+
+      /**
+       * Pushed from last to first so child 0 of the mirrored order is
+       * visited first.
+       */
+      for (int child = 7; child >= 0; child--) {
+        const Ref next = view.getChild(node, child ^ mirror);
+
+        if (view.isEmpty(next))
+          continue;
+
+        stack[top++] = {next,
+                        entry.min + glm::vec3((child >> 2) & 1,
+                                              (child >> 1) & 1, child & 1) *
+                                        half,
+                        half, crossed};
+      }
+
+      continue;
+    }
+
+    alignas(32) float enter[PACKET_SIZE];
+    alignas(32) float t0[3][PACKET_SIZE];
+
+    _mm256_store_ps(enter, tEnter);
+    _mm256_store_ps(t0[0], t0x);
+    _mm256_store_ps(t0[1], t0y);
+    _mm256_store_ps(t0[2], t0z);
+
+    for (int i = 0; i < PACKET_SIZE; i++) {
+      if (!((crossed >> i) & 1))
+        continue;
+
+      RayHit &hit = hits[i];
+
+      hit.voxel = voxel;
+      hit.distance = std::max(enter[i], 0.0f);
+
+      if (enter[i] > 0.0f) {
+        const int axis = enter[i] == t0[0][i]   ? 0
+                         : enter[i] == t0[1][i] ? 1
+                                                : 2;
+        hit.normal[axis] = directions[i][axis] < 0.0f ? 1 : -1;
+      }
+    }
+
+    done |= crossed;
+  }
+
+  return done;
+#else
+  (void)view;
+  (void)origin;
+  (void)directions;
+  (void)lanes;
+  (void)hits;
+  return 0;
+#endif
+}
@@ -0,0 +1,27 @@
+#include "Palette.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+Palette::Palette(std::initializer_list<Voxel> voxels) {
+  for (const Voxel &voxel : voxels)
+    add(voxel);
+}
+
+VoxelID Palette::add(const Voxel &voxel) {
+  auto it = std::find(m_Voxels.begin() + 1, m_Voxels.end(), voxel);
+
+  if (it != m_Voxels.end())
+    return static_cast<VoxelID>(std::distance(m_Voxels.begin(), it));
+
+  assert(m_Voxels.size() <= std::numeric_limits<VoxelID>::max());
+
+  m_Voxels.push_back(voxel);
+
+  return static_cast<VoxelID>(m_Voxels.size() - 1);
+}
+
+const Voxel &Palette::get(VoxelID id) const { return m_Voxels[id]; }
+
+size_t Palette::size() const { return m_Voxels.size(); }
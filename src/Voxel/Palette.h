@@ -0,0 +1,61 @@
+#pragma once
+
+#include <initializer_list>
+#include <vector>
+
+#include "Voxel/Voxel.h"
+
+/**
+ * The set of distinct voxels of a world.
+ *
+ * Octree nodes store a VoxelID into the palette instead of a pointer to a
+ * Voxel, so leaves need no indirection, comparing two nodes is an integer
+ * compare and a tree can be copied, serialized or read from other threads
+ * without pointing into memory it does not own.
+ *
+ * Id 0 is EMPTY_VOXEL and is never handed out.
+ *
+ * Example usage:
+ *
+ *   Palette palette;
+ *   VoxelID grass = palette.add(Voxel(34, 139, 34, 255));
+ *
+ *   tree.set(x, y, z, grass);
+ *   unsigned int color = palette.get(grass).color;
+ */
+class Palette {
+private:
+  /**
+   * The voxels indexed by their id.
+   * Index 0 is a placeholder for EMPTY_VOXEL.
+   */
+  std::vector<Voxel> m_Voxels = {Voxel()};
+
+public:
+  Palette() = default;
+
+  /**
+   * Constructs a palette with the voxels in order, the first one gets id 1.
+   */
+  Palette(std::initializer_list<Voxel> voxels);
+
+  /**
+   * Adds a voxel to the palette.
+   *
+   * @return The id of the voxel. If an equal voxel already exists, it's id is
+   * returned instead.
+   */
+  VoxelID add(const Voxel &voxel);
+
+  /**
+   * Returns the voxel with the given id.
+   * EMPTY_VOXEL returns a default constructed voxel.
+   */
+  const Voxel &get(VoxelID id) const;
+
+  /**
+   * Returns the number of ids in use, including EMPTY_VOXEL.
+   * Valid voxel ids are in the range [1, size()).
+   */
+  size_t size() const;
+};
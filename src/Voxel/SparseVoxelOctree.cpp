@@ -1,8 +1,12 @@
 #include "SparseVoxelOctree.h"
 
+#include <cassert>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 
+#include "Voxel/LinearOctree.h"
+
 static const std::vector<glm::ivec3> NEIGHBOUR_DIRECTIONS =
     {               // Cardinal directions (6)
         {1, 0, 0},  // +X (East)
@@ -36,188 +40,562 @@ static const std::vector<glm::ivec3> NEIGHBOUR_DIRECTIONS =
         {-1, -1, 1},
         {-1, -1, -1}};
 
-SparseVoxelOctree::SparseVoxelOctree()
-    : m_Size(256), m_Depth(8), m_Root(new Node(8)) {}
+SparseVoxelOctree::SparseVoxelOctree() : SparseVoxelOctree(256) {}
 
 SparseVoxelOctree::SparseVoxelOctree(int size)
     : m_Size(size), m_Depth(static_cast<uint8_t>(std::log2(size))),
-      m_Root(new Node(static_cast<uint8_t>(std::log2(size)))) {}
+      m_Root(m_Pool.allocate(m_Depth)),
+      m_RegionsPerAxis(std::max(1, size / DIRTY_REGION_SIZE)),
+      m_DirtyRegions(m_RegionsPerAxis * m_RegionsPerAxis * m_RegionsPerAxis) {
+  assert(m_Depth <= Node::MAX_DEPTH);
 
-SparseVoxelOctree::~SparseVoxelOctree() {
-  clear();
-  delete m_Root;
-  m_Root = nullptr;
+  markAllDirty();
 }
 
+SparseVoxelOctree::~SparseVoxelOctree() { m_Root = nullptr; }
+
 int SparseVoxelOctree::getSize() { return m_Size; }
 
 int SparseVoxelOctree::getDepth() { return m_Depth; }
 
 Node *SparseVoxelOctree::getRoot() { return m_Root; }
 
-void SparseVoxelOctree::set(uint64_t (&mask)[], Voxel *voxel) {
-  for (int z = 0; z < m_Size; z += 64)
-    for (int x = 0; x < m_Size; x += 64)
-      for (int y = 0; y < m_Size; y += 64)
-        set(mask, x, y, z, voxel, 64);
+void SparseVoxelOctree::set(uint64_t (&mask)[], VoxelID voxel) {
+  /**
+   * The pyramid keeps it's buffers between calls, building a chunk calls this
+   * once per material.
+   */
+  static thread_local BitPyramid pyramid;
+
+  pyramid.build(mask, m_Size);
+
+  set(m_Root, pyramid, 0, 0, 0, voxel);
+
+  markAllDirty();
 }
 
-void SparseVoxelOctree::set(uint64_t (&mask)[], int x, int y, int z,
-                            Voxel *voxel, int size) {
-  bool isFullBlock = true;
-
-  for (int dz = 0; dz < size && isFullBlock; ++dz)
-    for (int dx = 0; dx < size && isFullBlock; ++dx)
-      for (int dy = 0; dy < size && isFullBlock; ++dy) {
-        int ix = x + dx;
-        int iy = y + dy;
-        int iz = z + dz;
-
-        int index = ix + m_Size * (iz + m_Size * iy);
-        if (!(mask[index / 64] & (1UL << (index % 64)))) {
-          isFullBlock = false;
-          break;
-        }
-      }
+void SparseVoxelOctree::set(Node *node, const BitPyramid &pyramid, int x,
+                            int y, int z, VoxelID voxel) {
+  const int depth = node->depth;
 
-  if (isFullBlock) {
-    set(x, y, z, voxel, size);
+  if (!pyramid.isAny(depth, x, y, z))
     return;
-  }
 
-  if (size == 1) {
-    int index = x + m_Size * (z + m_Size * y);
-    if (mask[index / 64] & (1UL << (index % 64)))
-      set(x, y, z, voxel, 1);
+  if (pyramid.isFull(depth, x, y, z)) {
+    for (int i = 0; i < 8; i++) {
+      m_Pool.release(node->children[i]);
+      node->children[i] = nullptr;
+    }
+
+    node->voxel = voxel;
+    node->summarize();
     return;
   }
 
-  int half = size / 2;
+  /**
+   * Only part of this node is being replaced, push the existing voxel down
+   * into the children so the rest of it is kept.
+   */
+  if (node->voxel) {
+    for (int i = 0; i < 8; i++) {
+      node->children[i] = m_Pool.allocate(static_cast<uint8_t>(depth - 1));
+      node->children[i]->voxel = node->voxel;
+      node->children[i]->summarize();
+    }
+
+    node->voxel = EMPTY_VOXEL;
+  }
+
+  for (int i = 0; i < 8; i++) {
+    const int cx = (x << 1) | ((i >> 2) & 1);
+    const int cy = (y << 1) | ((i >> 1) & 1);
+    const int cz = (z << 1) | (i & 1);
+
+    if (!pyramid.isAny(depth - 1, cx, cy, cz))
+      continue;
+
+    if (!node->children[i])
+      node->children[i] = m_Pool.allocate(static_cast<uint8_t>(depth - 1));
 
-  for (int dz = 0; dz < size; dz += half)
-    for (int dx = 0; dx < size; dx += half)
-      for (int dy = 0; dy < size; dy += half)
-        set(mask, x + dx, y + dy, z + dz, voxel, half);
+    set(node->children[i], pyramid, cx, cy, cz, voxel);
+  }
+
+  merge(node);
+}
+
+void SparseVoxelOctree::merge(Node *node) {
+  /**
+   * Children that were emptied by an edit go back to the pool, a node whose
+   * children are all gone is empty itself and is dropped by it's parent.
+   */
+  for (Node *&child : node->children)
+    if (child && child->isEmpty()) {
+      m_Pool.release(child);
+      child = nullptr;
+    }
+
+  const VoxelID firstVoxel =
+      node->children[0] ? node->children[0]->voxel : EMPTY_VOXEL;
+
+  bool isUniform = firstVoxel;
+
+  for (int i = 1; i < 8 && isUniform; i++)
+    isUniform = node->children[i] && node->children[i]->voxel == firstVoxel;
+
+  if (isUniform) {
+    for (int i = 0; i < 8; i++) {
+      m_Pool.release(node->children[i]);
+      node->children[i] = nullptr;
+    }
+
+    node->voxel = firstVoxel;
+  }
+
+  node->summarize();
 }
 
-void SparseVoxelOctree::set(glm::vec3 position, Voxel *voxel, int leafSize) {
+void SparseVoxelOctree::build(const VoxelID *voxels) {
+  m_Pool.reset();
+
+  VoxelID uniform = EMPTY_VOXEL;
+
+  m_Root = build(voxels, 0, 0, 0, m_Depth, uniform);
+
+  if (!m_Root) {
+    m_Root = m_Pool.allocate(m_Depth);
+    m_Root->voxel = uniform;
+    m_Root->summarize();
+  }
+
+  markAllDirty();
+}
+
+Node *SparseVoxelOctree::build(const VoxelID *voxels, int x, int y, int z,
+                               uint8_t depth, VoxelID &uniform) {
+  /**
+   * Small regions are usually all air or all stone. Scanning them once is
+   * cheaper than building 8 levels of children only to collapse them. The
+   * scan stops at the first mismatch so mixed regions pay very little, and it
+   * is limited to small regions so a region is never rescanned more than a
+   * few times.
+   */
+  if (depth <= 3) {
+    const int size = 1 << depth;
+    const VoxelID first = voxels[x + m_Size * (z + m_Size * y)];
+
+    bool isUniform = true;
+
+    for (int dy = 0; dy < size && isUniform; dy++)
+      for (int dz = 0; dz < size && isUniform; dz++) {
+        const VoxelID *row =
+            &voxels[x + m_Size * ((z + dz) + m_Size * (y + dy))];
+        for (int dx = 0; dx < size; dx++)
+          isUniform &= row[dx] == first;
+      }
+
+    if (isUniform) {
+      uniform = first;
+      return nullptr;
+    }
+  }
+
+  Node *children[8];
+  VoxelID ids[8];
+
+  if (depth == 1) {
+    for (int i = 0; i < 8; i++) {
+      const int cx = x + ((i >> 2) & 1);
+      const int cy = y + ((i >> 1) & 1);
+      const int cz = z + (i & 1);
+
+      children[i] = nullptr;
+      ids[i] = voxels[cx + m_Size * (cz + m_Size * cy)];
+    }
+  } else {
+    const int half = 1 << (depth - 1);
+
+    for (int i = 0; i < 8; i++)
+      children[i] = build(voxels, x + ((i >> 2) & 1) * half,
+                          y + ((i >> 1) & 1) * half, z + (i & 1) * half,
+                          static_cast<uint8_t>(depth - 1), ids[i]);
+  }
+
+  bool isUniform = true;
+
+  for (int i = 0; i < 8 && isUniform; i++)
+    isUniform = !children[i] && ids[i] == ids[0];
+
+  if (isUniform) {
+    uniform = ids[0];
+    return nullptr;
+  }
+
+  Node *node = m_Pool.allocate(depth);
+
+  for (int i = 0; i < 8; i++) {
+    if (children[i])
+      node->children[i] = children[i];
+    else if (ids[i]) {
+      node->children[i] = m_Pool.allocate(static_cast<uint8_t>(depth - 1));
+      node->children[i]->voxel = ids[i];
+      node->children[i]->summarize();
+    }
+  }
+
+  node->summarize();
+
+  uniform = EMPTY_VOXEL;
+  return node;
+}
+
+void SparseVoxelOctree::set(glm::vec3 position, VoxelID voxel, int leafSize) {
   set(static_cast<int>(position.x), static_cast<int>(position.y),
       static_cast<int>(position.z), voxel, leafSize);
 }
 
-void SparseVoxelOctree::set(int x, int y, int z, Voxel *voxel, int leafSize) {
+void SparseVoxelOctree::set(int x, int y, int z, VoxelID voxel, int leafSize) {
   set(m_Root, x, y, z, voxel, leafSize, m_Size);
+  markDirty(x, y, z);
 }
 
-Node *SparseVoxelOctree::get(glm::vec3 position, Voxel *filter) {
+Node *SparseVoxelOctree::get(glm::vec3 position, VoxelID filter) {
   return get(static_cast<int>(position.x), static_cast<int>(position.y),
              static_cast<int>(position.z), filter);
 }
 
-Node *SparseVoxelOctree::get(int x, int y, int z, Voxel *filter) {
-  return get(m_Root, x, y, z, m_Size, filter);
+Node *SparseVoxelOctree::get(int x, int y, int z, VoxelID filter) {
+  /**
+   * m_Size is a power of two, any bit above the low m_Depth bits (including
+   * the sign bit) means the position is outside of this tree.
+   */
+  if ((x | y | z) & ~(m_Size - 1)) {
+    /**
+     * Arithmetic shifts floor towards negative infinity, so -1 >> depth is -1.
+     */
+    const int dx = x >> m_Depth;
+    const int dy = y >> m_Depth;
+    const int dz = z >> m_Depth;
+
+    if (dx < -1 || dx > 1 || dy < -1 || dy > 1 || dz < -1 || dz > 1)
+      return nullptr;
+
+    SparseVoxelOctree *neighbour = m_Neighbours[NeighbourIndex(dx, dy, dz)];
+
+    if (!neighbour)
+      return nullptr;
+
+    return neighbour->get(x & (m_Size - 1), y & (m_Size - 1),
+                          z & (m_Size - 1), filter);
+  }
+
+  Node *node = m_Root;
+
+  for (int shift = m_Depth - 1;; shift--) {
+    if (node->voxel) {
+      if (filter && filter != node->voxel)
+        return nullptr;
+      return node;
+    }
+
+    if (shift < 0)
+      return nullptr;
+
+    node = node->children[(((x >> shift) & 1) << 2) |
+                          (((y >> shift) & 1) << 1) | ((z >> shift) & 1)];
+
+    if (!node)
+      return nullptr;
+  }
 }
 
-void SparseVoxelOctree::set(Node *node, int x, int y, int z, Voxel *voxel,
+void SparseVoxelOctree::set(Node *node, int x, int y, int z, VoxelID voxel,
                             int leafSize, int size) {
   if (size == leafSize) {
+    /**
+     * The leaf now covers the whole region, any existing subtree is hidden
+     * behind it so give it back to the pool.
+     */
+    for (int i = 0; i < 8; i++) {
+      m_Pool.release(node->children[i]);
+      node->children[i] = nullptr;
+    }
+
     node->voxel = voxel;
+    node->summarize();
     return;
   }
 
   int half = size / 2;
 
+  if (node->voxel) {
+    if (node->voxel == voxel)
+      return;
+
+    /**
+     * The leaf covers more than the position, every child takes it's voxel
+     * and the one being set is replaced below.
+     */
+    for (int i = 0; i < 8; i++) {
+      node->children[i] =
+          m_Pool.allocate(static_cast<uint8_t>(node->depth - 1));
+      node->children[i]->voxel = node->voxel;
+      node->children[i]->summarize();
+    }
+
+    node->voxel = EMPTY_VOXEL;
+  }
+
   int index = ((x >= half) << 2) | ((y >= half) << 1) | (z >= half);
 
   if (!node->children[index])
-    node->children[index] = new Node(static_cast<uint8_t>(std::log2(half)));
+    node->children[index] =
+        m_Pool.allocate(static_cast<uint8_t>(std::log2(half)));
 
   this->set(node->children[index], x % half, y % half, z % half, voxel,
             leafSize, half);
 
-  if (!node->children[0] || !node->children[0]->voxel)
-    return;
+  merge(node);
+}
 
-  /**
-   * If all 8 children exist and are of the same voxel type.
-   * Delete all 8 children and set the parent voxel as their type.
-   */
-  Voxel *firstVoxel = node->children[0]->voxel;
+template <typename T>
+bool SparseVoxelOctree::getRegionMasks(int originX, int originY, int originZ,
+                                       VoxelID filter, T *rows, T *columns,
+                                       T *layers) {
+  bool hasVoxels = false;
 
-  for (int i = 0; i < 8; i++)
-    if (!node->children[i] || !node->children[i]->voxel ||
-        node->children[i]->voxel != firstVoxel)
-      return;
+  forEachLeaf(originX, originY, originZ, sizeof(T) * 8,
+              [&](int x, int y, int z, int size, VoxelID voxel) {
+                if (filter && filter != voxel)
+                  return;
 
-  for (int i = 0; i < 8; i++) {
-    delete node->children[i];
-    node->children[i] = nullptr;
-  }
+                hasVoxels = true;
+                FillRegionRows(x, y, z, size, rows);
+              });
 
-  node->voxel = firstVoxel;
-}
+  if (hasVoxels)
+    BitMatrix::RowsToAxes(rows, columns, layers);
 
-int SparseVoxelOctree::floorDiv(int a, int b) {
-  return (a >= 0) ? (a / b) : ((a - b + 1) / b);
+  return hasVoxels;
 }
 
-int SparseVoxelOctree::mod(int a, int b) {
-  int r = a % b;
-  return (r < 0) ? r + b : r;
+template bool SparseVoxelOctree::getRegionMasks<uint32_t>(int, int, int,
+                                                          VoxelID, uint32_t *,
+                                                          uint32_t *,
+                                                          uint32_t *);
+template bool SparseVoxelOctree::getRegionMasks<uint64_t>(int, int, int,
+                                                          VoxelID, uint64_t *,
+                                                          uint64_t *,
+                                                          uint64_t *);
+template bool SparseVoxelOctree::getRegionMasks<uint128_t>(int, int, int,
+                                                           VoxelID,
+                                                           uint128_t *,
+                                                           uint128_t *,
+                                                           uint128_t *);
+
+Node *SparseVoxelOctree::getRegionNode(int originX, int originY, int originZ,
+                                       int size) {
+  const int depth = static_cast<int>(std::log2(size));
+
+  /**
+   * Find the node that covers the region, a leaf above it covers the whole
+   * region.
+   */
+  Node *node = m_Root;
+
+  for (int shift = m_Depth - 1; shift >= depth && node && !node->voxel;
+       shift--)
+    node = node->children[(((originX >> shift) & 1) << 2) |
+                          (((originY >> shift) & 1) << 1) |
+                          ((originZ >> shift) & 1)];
+
+  return node;
 }
 
-Node *SparseVoxelOctree::get(Node *node, int x, int y, int z, int size,
-                             Voxel *filter) {
+uint32_t SparseVoxelOctree::getVoxelCount(int originX, int originY,
+                                          int originZ, int size) {
+  const Node *node = getRegionNode(originX, originY, originZ, size);
+
   if (!node)
-    return nullptr;
+    return 0;
 
-  if (x < 0 || y < 0 || z < 0 || x >= size || y >= size || z >= size) {
-    const glm::ivec3 np = {floorDiv(x, m_Size) + m_ChunkCoord.x,
-                           floorDiv(y, m_Size) + m_ChunkCoord.y,
-                           floorDiv(z, m_Size) + m_ChunkCoord.z};
+  /**
+   * A leaf above the region covers all of it.
+   */
+  if (node->voxel)
+    return static_cast<uint32_t>(size) * size * size;
 
-    auto it = m_Neighbours.find(np);
+  return node->count;
+}
 
-    if (it == m_Neighbours.end() || it->second == nullptr)
-      return nullptr;
+template <typename F>
+void SparseVoxelOctree::forEachLeafOnPlane(Node *node, int x, int y, int z,
+                                           int size, int axis, int plane,
+                                           F &f) {
+  if (!node || !node->count)
+    return;
 
-    return it->second->get({mod(x, m_Size), mod(y, m_Size), mod(z, m_Size)},
-                           filter);
+  if (node->voxel) {
+    f(x, y, z, size, node->voxel);
+    return;
   }
 
-  if (node->voxel) {
-    if (filter && *filter != *node->voxel)
-      return nullptr;
-    return node;
+  const int half = size / 2;
+
+  /**
+   * The children on the far half along the axis have this bit of their index
+   * on, only one half holds the plane.
+   */
+  const int bit = 2 - axis;
+  const int corner[3] = {x, y, z};
+  const int far = plane >= corner[axis] + half;
+
+  for (int i = 0; i < 8; i++) {
+    if (((i >> bit) & 1) != far)
+      continue;
+
+    forEachLeafOnPlane(node->children[i], x + ((i >> 2) & 1) * half,
+                       y + ((i >> 1) & 1) * half, z + (i & 1) * half, half,
+                       axis, plane, f);
   }
+}
 
-  int half = size / 2;
+template <typename T>
+void SparseVoxelOctree::getBoundarySlices(int originX, int originY,
+                                          int originZ,
+                                          T (&slices)[6][sizeof(T) * 8]) {
+  constexpr int N = sizeof(T) * 8;
 
-  int index = ((x >= half) << 2) | ((y >= half) << 1) | (z >= half);
+  std::memset(slices, 0, sizeof(slices));
+
+  for (int side = 0; side < 6; side++) {
+    const int axis = side / 2;
+
+    /**
+     * The region next to this side, and the plane of it that touches this
+     * region.
+     */
+    int origin[3] = {originX, originY, originZ};
+    origin[axis] += (side & 1) ? N : -N;
+
+    const int plane = (side & 1) ? 0 : N - 1;
+
+    SparseVoxelOctree *tree = this;
+
+    if ((origin[0] | origin[1] | origin[2]) & ~(m_Size - 1)) {
+      tree = m_Neighbours[NeighbourIndex(origin[0] >> m_Depth,
+                                         origin[1] >> m_Depth,
+                                         origin[2] >> m_Depth)];
+
+      if (!tree)
+        continue;
+
+      for (int &o : origin)
+        o &= m_Size - 1;
+    }
+
+    T *slice = slices[side];
+
+    auto fill = [&](int x, int y, int z, int size, VoxelID voxel) {
+      (void)voxel;
+
+      const T span = size >= N ? ~T(0) : ((T(1) << size) - 1);
 
-  return get(node->children[index], x % half, y % half, z % half, half, filter);
+      const int fast = axis == 1 ? x : y;
+      const int slow = axis == 2 ? x : z;
+
+      for (int a = slow; a < slow + size; a++)
+        slice[a] |= span << fast;
+    };
+
+    tree->forEachLeafOnPlane(
+        tree->getRegionNode(origin[0], origin[1], origin[2], N), 0, 0, 0, N,
+        axis, plane, fill);
+  }
 }
 
+template void SparseVoxelOctree::getBoundarySlices<uint32_t>(
+    int, int, int, uint32_t (&)[6][32]);
+template void SparseVoxelOctree::getBoundarySlices<uint64_t>(
+    int, int, int, uint64_t (&)[6][64]);
+template void SparseVoxelOctree::getBoundarySlices<uint128_t>(
+    int, int, int, uint128_t (&)[6][128]);
+
 void SparseVoxelOctree::clear() {
-  if (!m_Root)
+  m_Pool.reset();
+  m_Root = m_Pool.allocate(m_Depth);
+
+  markAllDirty();
+}
+
+void SparseVoxelOctree::markRegionDirty(int x, int y, int z) {
+  if ((x | y | z) & ~(m_Size - 1)) {
+    const int dx = x >> m_Depth;
+    const int dy = y >> m_Depth;
+    const int dz = z >> m_Depth;
+
+    if (dx < -1 || dx > 1 || dy < -1 || dy > 1 || dz < -1 || dz > 1)
+      return;
+
+    SparseVoxelOctree *neighbour = m_Neighbours[NeighbourIndex(dx, dy, dz)];
+
+    if (neighbour)
+      neighbour->markRegionDirty(x & (m_Size - 1), y & (m_Size - 1),
+                                 z & (m_Size - 1));
     return;
+  }
+
+  const int regionSize = std::min(m_Size, DIRTY_REGION_SIZE);
+
+  const int region = (x / regionSize) +
+                     m_RegionsPerAxis * ((y / regionSize) +
+                                         m_RegionsPerAxis * (z / regionSize));
 
-  m_Root->clear();
+  m_DirtyRegions[region].store(true);
 }
 
-size_t SparseVoxelOctree::getMemoryUsage(Node *node) {
-  if (!node)
-    return 0;
+void SparseVoxelOctree::markDirty(int x, int y, int z) {
+  markRegionDirty(x, y, z);
 
-  size_t size = sizeof(Node);
+  /**
+   * A position on the edge of a region also changes the faces of the region
+   * across that edge. Marking a position inside the same region again is
+   * harmless.
+   */
+  markRegionDirty(x - 1, y, z);
+  markRegionDirty(x + 1, y, z);
+  markRegionDirty(x, y - 1, z);
+  markRegionDirty(x, y + 1, z);
+  markRegionDirty(x, y, z - 1);
+  markRegionDirty(x, y, z + 1);
+}
 
-  if (node->voxel)
-    size += sizeof(Voxel);
+void SparseVoxelOctree::markAllDirty() {
+  for (std::atomic<bool> &dirty : m_DirtyRegions)
+    dirty.store(true);
+}
+
+std::vector<glm::ivec3> SparseVoxelOctree::takeDirtyRegions() {
+  const int regionSize = std::min(m_Size, DIRTY_REGION_SIZE);
 
-  for (int i = 0; i < 8; ++i)
-    size += getMemoryUsage(node->children[i]);
+  std::vector<glm::ivec3> regions;
 
-  return size;
+  for (int i = 0; i < static_cast<int>(m_DirtyRegions.size()); i++) {
+    if (!m_DirtyRegions[i].exchange(false))
+      continue;
+
+    regions.emplace_back((i % m_RegionsPerAxis) * regionSize,
+                         ((i / m_RegionsPerAxis) % m_RegionsPerAxis) *
+                             regionSize,
+                         (i / (m_RegionsPerAxis * m_RegionsPerAxis)) *
+                             regionSize);
+  }
+
+  return regions;
+}
+
+void SparseVoxelOctree::clearDirtyRegions() {
+  for (std::atomic<bool> &dirty : m_DirtyRegions)
+    dirty.store(false);
 }
 
 void SparseVoxelOctree::setNeighbours(
@@ -225,111 +603,107 @@ void SparseVoxelOctree::setNeighbours(
     const std::unordered_map<glm::ivec3, SparseVoxelOctree *> &chunks) {
   m_ChunkCoord = chunkCoord;
 
-  m_Neighbours.clear();
-  m_Neighbours.reserve(NEIGHBOUR_DIRECTIONS.size());
+  m_Neighbours.fill(nullptr);
+  m_Neighbours[NeighbourIndex(0, 0, 0)] = this;
 
   for (const glm::ivec3 &dir : NEIGHBOUR_DIRECTIONS) {
-    glm::ivec3 np = chunkCoord + dir;
-    if (chunks.contains(np))
-      m_Neighbours[np] = chunks.at(np);
-    else
-      m_Neighbours[np] = nullptr;
+    auto it = chunks.find(chunkCoord + dir);
+    if (it != chunks.end())
+      m_Neighbours[NeighbourIndex(dir.x, dir.y, dir.z)] = it->second;
   }
 }
 
 size_t SparseVoxelOctree::getTotalMemoryUsage() {
-  return sizeof(SparseVoxelOctree) + getMemoryUsage(m_Root);
+  return sizeof(SparseVoxelOctree) + m_Pool.getMemoryUsage();
 }
 
-Voxel *SparseVoxelOctree::rayTrace(const glm::vec3 &origin,
-                                   const glm::vec3 &direction) {
+size_t SparseVoxelOctree::getNodeCount() const { return m_Pool.getNodeCount(); }
 
-  glm::ivec3 coord = glm::floor(glm::vec3(origin / (float)m_Size));
-
-  // if (coord != m_ChunkCoord) {
-  //   glm::ivec3 relative = coord - m_ChunkCoord;
+VoxelID SparseVoxelOctree::rayTrace(const glm::vec3 &origin,
+                                    const glm::vec3 &direction) {
+  RayHit hit;
+  rayTrace(origin, direction, hit);
+  return hit.voxel;
+}
 
-  //   auto it = m_Neighbours.find(relative);
-  //   if (it == m_Neighbours.end())
-  //     return nullptr;
+namespace {
 
-  //   glm::vec3 localOrigin = origin - glm::vec3(relative * m_Size);
-  //   return it->second->rayTrace(localOrigin, direction);
-  // }
+/**
+ * Reads a SparseVoxelOctree for OctreeRay, a node is referred to by it's
+ * pointer.
+ */
+struct PointerView {
+  using Ref = const Node *;
 
-  return rayTrace(m_Root, origin, direction, glm::vec3(0), m_Size);
-}
+  const Node *root;
+  int size;
+  int depth;
 
-bool inline intersectAABB(const glm::vec3 &rayOrigin, const glm::vec3 &rayDir,
-                          const glm::vec3 &min, const glm::vec3 &max,
-                          float &tMin, float &tMax) {
-  tMin = 0.0f;
-  tMax = 1e30f;
+  Ref getRoot() const { return root; }
+  int getSize() const { return size; }
+  int getDepth() const { return depth; }
 
-  for (int i = 0; i < 3; i++)
-    if (rayDir[i] != 0.0f) {
-      float t1 = (min[i] - rayOrigin[i]) / rayDir[i];
-      float t2 = (max[i] - rayOrigin[i]) / rayDir[i];
+  bool isEmpty(Ref node) const { return !node || !node->count; }
 
-      if (t1 > t2)
-        std::swap(t1, t2);
+  VoxelID getVoxel(Ref node) const { return node->voxel; }
 
-      tMin = std::max(tMin, t1);
-      tMax = std::min(tMax, t2);
+  Ref getChild(Ref node, int child) const { return node->children[child]; }
+};
 
-      if (tMin > tMax)
-        return false;
-    } else if (rayOrigin[i] < min[i] || rayOrigin[i] > max[i])
-      return false;
+} // namespace
 
-  return true;
+bool SparseVoxelOctree::rayTrace(const glm::vec3 &origin,
+                                 const glm::vec3 &direction, RayHit &hit) {
+  return OctreeRay::Trace(PointerView{m_Root, m_Size, m_Depth}, origin,
+                          direction, hit);
 }
 
-Voxel *SparseVoxelOctree::rayTrace(Node *node, const glm::vec3 &origin,
-                                   const glm::vec3 &direction,
-                                   glm::vec3 nodeMin, int size) {
-  float tMin, tMax;
-
-  if (!intersectAABB(origin, direction, nodeMin, nodeMin + glm::vec3(size),
-                     tMin, tMax))
-    return nullptr;
-
-  if (node->voxel)
-    return node->voxel;
+uint8_t SparseVoxelOctree::rayTrace(const glm::vec3 &origin,
+                                    const glm::vec3 (&directions)[PACKET_SIZE],
+                                    uint8_t lanes,
+                                    RayHit (&hits)[PACKET_SIZE]) {
+  return OctreeRay::Trace(PointerView{m_Root, m_Size, m_Depth}, origin,
+                          directions, lanes, hits);
+}
 
-  if (!node->children)
-    return nullptr;
+LinearOctree SparseVoxelOctree::freeze() const {
+  /**
+   * Breadth first, so the children of every node are written next to each
+   * other. The source nodes are kept in a parallel array, linear[i] is the
+   * copy of nodes[i].
+   */
+  std::vector<const Node *> nodes = {m_Root};
+  std::vector<LinearNode> linear(1);
 
-  float half = size / 2.0f;
+  nodes.reserve(m_Pool.getNodeCount());
+  linear.reserve(m_Pool.getNodeCount());
 
-  int dirX = direction.x >= 0 ? 0 : 1;
-  int dirY = direction.y >= 0 ? 0 : 1;
-  int dirZ = direction.z >= 0 ? 0 : 1;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    const Node *node = nodes[i];
 
-  int order[8];
-  int index = 0;
+    linear[i].depth = node->depth;
 
-  for (int dx = 0; dx <= 1; dx++)
-    for (int dy = 0; dy <= 1; dy++)
-      for (int dz = 0; dz <= 1; dz++)
-        order[index++] = ((dx ^ dirX) << 2) | ((dy ^ dirY) << 1) | (dz ^ dirZ);
+    if (node->voxel) {
+      linear[i].voxel = node->voxel;
+      continue;
+    }
 
-  for (int j = 0; j < 8; j++) {
-    int i = order[j];
+    linear[i].firstChild = static_cast<uint32_t>(linear.size());
 
-    Node *child = node->children[i];
-    if (!child)
-      continue;
+    for (int c = 0; c < 8; c++) {
+      const Node *child = node->children[c];
 
-    int x = (i & 4) ? 1 : 0;
-    int y = (i & 2) ? 1 : 0;
-    int z = (i & 1) ? 1 : 0;
+      if (!child || !child->count)
+        continue;
 
-    glm::vec3 childMin = nodeMin + glm::vec3(x, y, z) * half;
+      linear[i].childMask |= (1 << c);
 
-    if (Voxel *hit = rayTrace(child, origin, direction, childMin, half))
-      return hit;
+      nodes.push_back(child);
+      linear.emplace_back();
+    }
   }
 
-  return nullptr;
-}
\ No newline at end of file
+  linear.shrink_to_fit();
+
+  return LinearOctree(m_Size, std::move(linear));
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <execution>
 #include <glm/glm.hpp>
 #include <unordered_map>
@@ -8,11 +10,29 @@
 
 #include "Debug.h"
 #include "Engine/Types.h"
+#include "Voxel/BitMatrix.h"
+#include "Voxel/BitPyramid.h"
 #include "Voxel/Common.h"
 #include "Voxel/Node.h"
+#include "Voxel/NodePool.h"
+#include "Voxel/OctreeRay.h"
 #include "Voxel/Voxel.h"
 
+class LinearOctree;
+
 class SparseVoxelOctree {
+public:
+  /**
+   * The side length of the regions edits are tracked in, the same as the
+   * regions a chunk is meshed in.
+   */
+  static constexpr int DIRTY_REGION_SIZE = 64;
+
+  /**
+   * The number of rays traced together by the packet rayTrace().
+   */
+  static constexpr int PACKET_SIZE = OctreeRay::PACKET_SIZE;
+
 private:
   /**
    * The total side length of the root node's region.
@@ -26,6 +46,13 @@ private:
    */
   uint8_t m_Depth;
 
+  /**
+   * Owns every node of this tree, including the root.
+   * Nodes are carved out of slabs so building a chunk does not hit the global
+   * allocator per node, and clear() releases them all at once.
+   */
+  NodePool m_Pool;
+
   /**
    * Pointer to the root node of the Sparse Voxel Octree.
    * Should never be empty, is always initialized in the constructor.
@@ -45,24 +72,60 @@ private:
   glm::ivec3 m_ChunkCoord{0, 0, 0};
 
   /**
-   * Map of neighboring SVO chunks keyed by their relative chunk-grid position.
-   * For example: (1, 0, 0) → right neighbor, (-1, 0, 0) → left neighbor, etc.
-   * Enables out-of-bounds lookups across adjacent SVOs.
+   * The neighbouring SVO chunks indexed by their relative chunk-grid position,
+   * see NeighbourIndex(). For example: (1, 0, 0) → right neighbor,
+   * (-1, 0, 0) → left neighbor, etc. Slot 13 (0, 0, 0) is this tree.
+   * Enables out-of-bounds lookups across adjacent SVOs without hashing.
+   */
+  std::array<SparseVoxelOctree *, 27> m_Neighbours{};
+
+  /**
+   * The number of DIRTY_REGION_SIZE regions along each axis of the tree.
    */
-  std::unordered_map<glm::ivec3, SparseVoxelOctree *> m_Neighbours;
+  int m_RegionsPerAxis = 1;
+
+  /**
+   * One flag per region, index x + r * (y + r * z) where r is
+   * m_RegionsPerAxis. See markDirty().
+   *
+   * Atomic, an edit of the tree next to this one marks regions of this tree
+   * while this tree is meshed.
+   */
+  std::vector<std::atomic<bool>> m_DirtyRegions;
 
 private:
   /**
    * Internal recursive setter that applies a voxel to all positions marked in
    * the bitmask. Called by the public `set(mask, voxel)` method.
    *
-   * @param mask   A bitmask indicating which voxels to set.
-   * @param x,y,z  The origin (offset) position in voxel-space for this mask
-   * block.
-   * @param voxel  The voxel type to set at the marked positions.
-   * @param size   The current size of the region being processed.
+   * Walks the tree and the pyramid of the mask together, top down. Blocks
+   * that are empty in the mask are skipped, blocks that are full become a
+   * single leaf, only mixed blocks are descended into.
+   *
+   * @param node     Current node in the octree.
+   * @param pyramid  The full/any summaries of the mask.
+   * @param x,y,z    The position of the node in the coordinates of the
+   * pyramid level node->depth.
+   * @param voxel    The palette id to set at the marked positions.
+   */
+  void set(Node *node, const BitPyramid &pyramid, int x, int y, int z,
+           VoxelID voxel);
+
+  /**
+   * Internal recursive builder, called by the public `build(voxels)` method.
+   *
+   * Builds the children first and only creates a node for a region whose
+   * children are not all the same voxel, a uniform region is returned as a
+   * palette id and becomes a leaf (or nothing, if empty) in it's parent.
+   *
+   * @param voxels   The dense grid of palette ids.
+   * @param x,y,z    The origin of the region in voxel-space.
+   * @param depth    log2 of the size of the region.
+   * @param uniform  Set to the palette id of the region if it is uniform.
+   * @return         The node of the region, or nullptr if it is uniform.
    */
-  void set(uint64_t (&mask)[], int x, int y, int z, Voxel *voxel, int size);
+  Node *build(const VoxelID *voxels, int x, int y, int z, uint8_t depth,
+              VoxelID &uniform);
 
   /**
    * Internal recursive setter that traverses and builds the tree as needed.
@@ -70,60 +133,70 @@ private:
    *
    * @param node      Current node in the octree.
    * @param x,y,z     Local voxel-space coordinates at this level.
-   * @param voxel     The voxel to assign at the final leaf.
+   * @param voxel     The palette id to assign at the final leaf.
    * @param leafSize  The target size of a leaf node (typically 1).
    * @param size      The size of the region represented by this node.
    */
-  void set(Node *node, int x, int y, int z, Voxel *voxel, int leafSize,
+  void set(Node *node, int x, int y, int z, VoxelID voxel, int leafSize,
            int size);
 
   /**
-   * Internal recursive getter that traverses the tree to find a voxel at the
-   * given position. Called by the public `get(x, y, z)` and `get(vec3)`
-   * methods.
-   *
-   * @param node    Current node in the octree.
-   * @param x,y,z   Local voxel-space coordinates at this level.
-   * @param size    The size of the region represented by this node.
-   * @param filter  Optional filter; only returns nodes matching this voxel
-   * type.
-   * @return        Pointer to the node at the target position, or nullptr if
-   * not found or filtered out.
+   * Releases the children that are empty, collapses the children into the
+   * node if they are 8 leaves of the same voxel, then updates the summary of
+   * the node. Called on the way back up
+   * from every change, so the summaries of every node on the path are up to
+   * date.
    */
-  Node *get(Node *node, int x, int y, int z, int size, Voxel *filter = nullptr);
+  void merge(Node *node);
 
   /**
-   * Returns the total memory used in bytes by this node and all it's children.
+   * Internal recursive walk for `forEachLeaf()`.
+   *
+   * @param node   Current node in the octree.
+   * @param x,y,z  The position of the node relative to the region.
+   * @param size   The size of the region represented by this node.
    */
-  size_t getMemoryUsage(Node *node);
+  template <typename F>
+  void forEachLeaf(Node *node, int x, int y, int z, int size, F &f);
 
   /**
-   * Performs floor division of a by b.
-   * This ensures correct behavior for negative dividends, returning the
-   * mathematical floor of the division instead of truncating toward zero.
+   * Internal recursive walk for `forEachCell()`.
    *
-   * Examples:
-   *   floorDiv( 5,  2) ->  2
-   *   floorDiv(-5,  2) -> -3
-   *   floorDiv( 5, -2) -> -3
-   *   floorDiv(-5, -2) ->  2
+   * @param node   Current node in the octree.
+   * @param x,y,z  The position of the node relative to the region.
+   * @param size   The size of the region represented by this node.
    */
-  int floorDiv(int a, int b);
+  template <typename F>
+  void forEachCell(Node *node, int x, int y, int z, int size, int cellSize,
+                   F &f);
 
   /**
-   * Computes the true modulo (remainder) of a divided by b.
-   * Unlike the default % operator in C++, this ensures the result is always
-   * non-negative and in the range [0, b), even when a is negative.
-   *
-   * Examples:
-   *   mod( 5,  2) -> 1
-   *   mod(-5,  2) -> 1
-   *   mod( 5, -2) -> -1
-   *   mod(-5, -2) -> -1
+   * Like `forEachLeaf()`, but only descends into children that cross the
+   * plane at `plane` along the axis (0 x, 1 y, 2 z), relative to the region.
    */
-  int mod(int a, int b);
+  template <typename F>
+  void forEachLeafOnPlane(Node *node, int x, int y, int z, int size, int axis,
+                          int plane, F &f);
 
-  Voxel *rayTrace(Node *node, const glm::vec3 &origin, const glm::vec3 &direction, glm::vec3 nodeMin, int size);
+  /**
+   * Returns the node that covers the size³ region at the origin, or a leaf
+   * above it that covers the whole region, or nullptr if it is empty.
+   */
+  Node *getRegionNode(int originX, int originY, int originZ, int size);
+
+  /**
+   * Returns the slot in m_Neighbours of the chunk at the relative chunk-grid
+   * position (dx, dy, dz), each in [-1, 1].
+   */
+  static constexpr int NeighbourIndex(int dx, int dy, int dz) {
+    return (dx + 1) + 3 * ((dy + 1) + 3 * (dz + 1));
+  }
+
+  /**
+   * Marks the region that holds the position, positions outside this tree
+   * are forwarded to the neighbour they fall in.
+   */
+  void markRegionDirty(int x, int y, int z);
 
 public:
   /**
@@ -135,7 +208,7 @@ public:
    * Constructs a Sparse Voxel Octree with the given spatial size.
    *
    * @param size  The side length of the root node's region (e.g., 256 for a
-   * 256³ volume).
+   * 256³ volume), at most 2^Node::MAX_DEPTH.
    */
   SparseVoxelOctree(int size);
 
@@ -197,56 +270,213 @@ public:
    *   tree.set(mask, grassVoxel);
    *
    * @param mask   A bitmask indicating which voxels to set (1 = set, 0 = skip).
-   * @param voxel  Pointer to the voxel type to set at the marked positions.
+   * @param voxel  The palette id to set at the marked positions.
+   */
+  void set(uint64_t (&mask)[], VoxelID voxel);
+
+  /**
+   * Replaces the contents of the tree with a dense grid of palette ids.
+   *
+   * Unlike `set(mask, voxel)` which is called once per material, this builds
+   * every material in a single bottom up pass. Uniform regions collapse into
+   * their parent as they are built, so no node is created only to be released
+   * again.
+   *
+   * The grid uses the same flattened layout as the bitmask,
+   * (x + size * (z + size * y)), with one palette id per voxel.
+   * EMPTY_VOXEL marks an empty position.
+   *
+   * Example usage:
+   *
+   *   std::vector<VoxelID> voxels(size * size * size, EMPTY_VOXEL);
+   *
+   *   for (int y = 0; y < height; y++)
+   *     voxels[x + size * (z + size * y)] = y < 16 ? STONE : GRASS;
+   *
+   *   tree.build(voxels.data());
+   *
+   * @param voxels  size³ palette ids.
    */
-  void set(uint64_t (&mask)[], Voxel *voxel);
+  void build(const VoxelID *voxels);
 
   /**
    * Sets a voxel at the given 3D world position.
    *
    * @param position  The world-space position to place the voxel at.
-   * @param voxel     The voxel data to insert.
+   * @param voxel     The palette id of the voxel to insert.
    * @param leafSize  The smallest voxel size (default is 1 unit).
    */
-  void set(glm::vec3 position, Voxel *voxel, int leafSize = 1);
+  void set(glm::vec3 position, VoxelID voxel, int leafSize = 1);
 
   /**
    * Retrieves the node at the given 3D world position.
    *
    * @param position  The world-space position to query.
-   * @param filter    Optional filter; if provided, only matching voxels are
-   * returned.
+   * @param filter    Optional filter; if provided, only voxels with this
+   * palette id are returned.
    * @return          Pointer to the node at that position, or nullptr if not
    * found or filtered out.
    */
-  Node *get(glm::vec3 position, Voxel *filter = nullptr);
+  Node *get(glm::vec3 position, VoxelID filter = EMPTY_VOXEL);
 
   /**
-   * Sets a voxel at the given 3D world position.
+   * Sets a voxel at the given 3D world position. The regions that need to be
+   * meshed again are marked dirty, see markDirty().
+   *
+   * A leaf that covers more than the position is split first, the rest of
+   * it keeps it's voxel.
    *
    * @param x, y, z   The world-space position to place the voxel at.
-   * @param voxel     The voxel data to insert.
+   * @param voxel     The palette id of the voxel to insert.
    * @param leafSize  The smallest voxel size (default is 1 unit).
    */
-  void set(int x, int y, int z, Voxel *voxel, int leafSize = 1);
+  void set(int x, int y, int z, VoxelID voxel, int leafSize = 1);
 
   /**
    * Retrieves the node at the given 3D world position.
    *
+   * The tree is walked iteratively, every level picks it's child from one bit
+   * of each coordinate. Positions outside this tree are forwarded to the
+   * neighbour they fall in, all neighbours must have the same size.
+   *
    * @param x, y, z   The world-space position to query.
-   * @param filter    Optional filter; if provided, only matching voxels are
-   * returned.
+   * @param filter    Optional filter; if provided, only voxels with this
+   * palette id are returned.
    * @return          Pointer to the node at that position, or nullptr if not
    * found or filtered out.
    */
-  Node *get(int x, int y, int z, Voxel *filter = nullptr);
+  Node *get(int x, int y, int z, VoxelID filter = EMPTY_VOXEL);
+
+  /**
+   * Calls `f(x, y, z, size, voxel)` once for every leaf inside the size³
+   * region at the origin, with x, y, z relative to the region. A leaf that
+   * covers the whole region is reported once with the size of the region.
+   *
+   * The region must lie inside this tree, aligned to size.
+   *
+   * @param originX, originY, originZ  The origin of the region.
+   * @param size  The side length of the region, a power of two.
+   * @param f     Called with (int x, int y, int z, int size, VoxelID voxel).
+   */
+  template <typename F>
+  void forEachLeaf(int originX, int originY, int originZ, int size, F &&f);
+
+  /**
+   * Returns the number of solid voxels inside the size³ region at the
+   * origin, read from the node summaries without walking the region.
+   *
+   * The region must lie inside this tree, aligned to size.
+   */
+  uint32_t getVoxelCount(int originX, int originY, int originZ, int size);
+
+  /**
+   * Like `forEachLeaf()`, but the tree is only walked down to nodes of
+   * cellSize, each is reported as one cell with it's average voxel, see
+   * Node::getAverageVoxel(). x, y, z and size are in cells, a leaf larger
+   * than a cell is reported once with it's size in cells.
+   *
+   * @param cellSize  The side length of a cell, a power of two no larger than
+   * size.
+   */
+  template <typename F>
+  void forEachCell(int originX, int originY, int originZ, int size,
+                   int cellSize, F &&f);
+
+  /**
+   * Turns on the bits of a size³ box at (x, y, z) in the row mask of an
+   * N×N×N region, N is the number of bits in T. See `getRegionMasks()` for the
+   * layout, the other two masks are transposes of the rows, see
+   * BitMatrix::RowsToAxes().
+   */
+  template <typename T>
+  static void FillRegionRows(int x, int y, int z, int size, T *rows) {
+    constexpr int N = sizeof(T) * 8;
+
+    const T span = size >= N ? ~T(0) : ((T(1) << size) - 1);
+
+    for (int a = 0; a < size; a++)
+      for (int b = 0; b < size; b++)
+        rows[(y + b) + N * (z + a)] |= span << x;
+  }
 
   /**
-   * Calls node.clear() on the root node.
-   * This clears the root node and all it's children.
-   * The root node will not be destroyed, only cleared. All children will be
-   * cleared and deleted.alignas The root node will be destroyed once the
-   * destructor of the SVO is called.
+   * Writes the occupancy of a cubic region into three bitmasks, one per axis,
+   * in a single walk of the tree. A uniform subtree is written with one word
+   * operation per row instead of one lookup per voxel, the columns and layers
+   * are then transposed from the rows.
+   *
+   * The region is N×N×N where N is the number of bits in T (32, 64 or 128)
+   * and must lie inside this tree, aligned to N. Every mask holds N×N words:
+   *
+   *   rows[y + N * z]     bit x
+   *   columns[x + N * z]  bit y
+   *   layers[y + N * x]   bit z
+   *
+   * The masks are not cleared, bits are only turned on.
+   *
+   * @param originX, originY, originZ  The origin of the region.
+   * @param filter   Optional filter; if provided, only voxels with this
+   * palette id are written.
+   * @return         True if any voxel was written.
+   */
+  template <typename T>
+  bool getRegionMasks(int originX, int originY, int originZ, VoxelID filter,
+                      T *rows, T *columns, T *layers);
+
+  /**
+   * Writes the solid voxels just outside each of the six sides of a cubic
+   * region, one N×N slice per side, so a mesher can tell if the faces on the
+   * edge of the region are hidden without looking up single voxels. Sides
+   * outside this tree are read from the neighbours, a missing neighbour is
+   * empty.
+   *
+   * The region is N×N×N where N is the number of bits in T and must lie
+   * inside this tree, aligned to N. The slices are indexed like the line of
+   * `getRegionMasks()` that ends on that side:
+   *
+   *   slices[0] x - 1, slices[1] x + N   [z] bit y   (rows)
+   *   slices[2] y - 1, slices[3] y + N   [z] bit x   (columns)
+   *   slices[4] z - 1, slices[5] z + N   [x] bit y   (layers)
+   *
+   * Only the leaves that touch each side are walked. The slices are cleared
+   * first.
+   *
+   * @param originX, originY, originZ  The origin of the region.
+   */
+  template <typename T>
+  void getBoundarySlices(int originX, int originY, int originZ,
+                         T (&slices)[6][sizeof(T) * 8]);
+
+  /**
+   * Marks the region that holds the position dirty, and every region next to
+   * it across a face the position touches, since the faces on that side may
+   * have been hidden or exposed. Regions of the neighbouring trees are marked
+   * in the neighbour, so setNeighbours() must have been called.
+   */
+  void markDirty(int x, int y, int z);
+
+  /**
+   * Marks every region dirty, a bulk set() or build() changes the whole tree.
+   */
+  void markAllDirty();
+
+  /**
+   * Returns the origins of the dirty regions and clears them. A region marked
+   * while this runs is either returned or left dirty.
+   */
+  std::vector<glm::ivec3> takeDirtyRegions();
+
+  /**
+   * Clears every dirty region, call before the whole tree is meshed so edits
+   * made while it's meshed are kept.
+   */
+  void clearDirtyRegions();
+
+  /**
+   * Releases every node back to the node pool in O(1) and allocates a fresh
+   * root. Any Node pointer previously returned by this tree is invalid after
+   * this call. The pool keeps it's slabs so rebuilding the tree does not
+   * allocate again.
    */
   void clear();
 
@@ -256,6 +486,7 @@ public:
    * this SVO, it will automatically lookup in the correct neighbouring SVO.
    *
    * Neighbours are keyed by their global position relative to each other.
+   * Only the 26 chunks around chunkCoord are kept.
    * (0,0,0) => center
    * (1,0,0) => center right
    * (-1,0,0) => center left
@@ -272,10 +503,120 @@ public:
 
   /**
    * Returns the total memory usage of the SVO in bytes.
+   * This is the footprint of the node slabs, used or not.
    * This does not include neighbours.
    */
   size_t getTotalMemoryUsage();
 
+  /**
+   * Returns the number of nodes of the tree.
+   */
+  size_t getNodeCount() const;
+
+  /**
+   * Returns the palette id of the first voxel hit by the ray, or EMPTY_VOXEL.
+   */
+  VoxelID rayTrace(const glm::vec3 &origin, const glm::vec3 &direction);
+
+  /**
+   * Finds the first voxel hit by the ray inside this tree.
+   *
+   * The tree is walked front to back with a parametric traversal: the t at
+   * which the ray crosses the planes of the root is computed once, every
+   * child's t span is taken from it's parent's without dividing, and the
+   * next child is picked from the plane the ray leaves through. Subtrees
+   * without solid voxels are skipped.
+   *
+   * The ray is not followed into the neighbours, a ray that leaves the tree
+   * misses. Walk the grid of chunks and trace each one to cross chunks.
+   *
+   * @param origin     The origin of the ray, local to this tree.
+   * @param direction  The direction of the ray, need not be normalized.
+   * @param hit        Set to the hit, if there is one.
+   * @return           True if the ray hit a voxel.
+   */
+  bool rayTrace(const glm::vec3 &origin, const glm::vec3 &direction,
+                RayHit &hit);
+
+  /**
+   * Traces a packet of rays from the same origin together, same result as
+   * tracing each lane on it's own.
+   *
+   * With ENABLE_AVX256 the lanes share one walk of the tree and the t spans
+   * of all 8 are computed at once. The children of a node are visited in
+   * mirrored index order, which is front to back for every ray heading into
+   * the same octant. A lane stops at it's first hit and the walk stops when
+   * no lane is left. A packet whose directions differ in sign on an axis, or
+   * any packet without ENABLE_AVX256, is traced one lane at a time.
+   *
+   * @param origin      The origin of every ray, local to this tree.
+   * @param directions  The direction of each lane.
+   * @param lanes       The lanes to trace, bit i is lane i.
+   * @param hits        Set for every traced lane.
+   * @return            The lanes that hit a voxel.
+   */
+  uint8_t rayTrace(const glm::vec3 &origin,
+                   const glm::vec3 (&directions)[PACKET_SIZE], uint8_t lanes,
+                   RayHit (&hits)[PACKET_SIZE]);
+
+  /**
+   * Returns a read only copy of the tree in the compact layout of
+   * LinearOctree, for lookups and rays once the tree is done being edited.
+   * Later edits are not reflected, freeze again instead.
+   *
+   * Subtrees without solid voxels are left out.
+   */
+  LinearOctree freeze() const;
+};
+
+template <typename F>
+void SparseVoxelOctree::forEachLeaf(int originX, int originY, int originZ,
+                                    int size, F &&f) {
+  forEachLeaf(getRegionNode(originX, originY, originZ, size), 0, 0, 0, size,
+              f);
+}
+
+template <typename F>
+void SparseVoxelOctree::forEachLeaf(Node *node, int x, int y, int z, int size,
+                                    F &f) {
+  if (!node || !node->count)
+    return;
+
+  if (node->voxel) {
+    f(x, y, z, size, node->voxel);
+    return;
+  }
+
+  const int half = size / 2;
+
+  for (int i = 0; i < 8; i++)
+    forEachLeaf(node->children[i], x + ((i >> 2) & 1) * half,
+                y + ((i >> 1) & 1) * half, z + (i & 1) * half, half, f);
+}
+
+template <typename F>
+void SparseVoxelOctree::forEachCell(int originX, int originY, int originZ,
+                                    int size, int cellSize, F &&f) {
+  forEachCell(getRegionNode(originX, originY, originZ, size), 0, 0, 0, size,
+              cellSize, f);
+}
+
+template <typename F>
+void SparseVoxelOctree::forEachCell(Node *node, int x, int y, int z, int size,
+                                    int cellSize, F &f) {
+  if (!node || !node->count)
+    return;
+
+  if (node->voxel || size == cellSize) {
+    f(x / cellSize, y / cellSize, z / cellSize, size / cellSize,
+      node->getAverageVoxel());
+    return;
+  }
+
+  const int half = size / 2;
 
-  Voxel *rayTrace(const glm::vec3 &origin, const glm::vec3 &direction);
-};
\ No newline at end of file
+  for (int i = 0; i < 8; i++)
+    forEachCell(node->children[i], x + ((i >> 2) & 1) * half,
+                y + ((i >> 1) & 1) * half, z + (i & 1) * half, half, cellSize,
+                f);
+}
@@ -1,6 +1,17 @@
 #pragma once
 #include <glm/glm.hpp>
 
+/**
+ * Index of a voxel in a Palette.
+ * The octree stores these instead of pointers to voxels.
+ */
+using VoxelID = uint16_t;
+
+/**
+ * The palette id of an empty voxel, it is never a valid palette entry.
+ */
+const VoxelID EMPTY_VOXEL = 0;
+
 struct Voxel {
   unsigned int color = 0;
   unsigned int material = 0;
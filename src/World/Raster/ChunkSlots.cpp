@@ -0,0 +1,90 @@
+#include "ChunkSlots.h"
+
+using namespace Raster;
+
+ChunkSlots::ChunkSlots(Buffer *buffer) : m_Buffer(buffer) {}
+
+void ChunkSlots::upload(const glm::ivec3 &coord, const ChunkMesh &mesh) {
+  if (mesh.quads.empty())
+    return release(coord);
+
+  unsigned int slot;
+
+  auto it = m_Chunks.find(coord);
+
+  if (it != m_Chunks.end())
+    slot = it->second;
+  else {
+    if (!m_Free.empty()) {
+      slot = m_Free.back();
+      m_Free.pop_back();
+    } else {
+      slot = m_Buffer->addPartition(0);
+      m_Slots.emplace_back();
+    }
+
+    m_Chunks[coord] = slot;
+    m_Slots[slot].coord = coord;
+    m_Slots[slot].used = true;
+  }
+
+  /**
+   * Grows the partition if the quads don't fit, with the buffer's resize
+   * factor as headroom so a chunk that is edited a few times does not resize
+   * the buffer every time.
+   */
+  m_Buffer->upsert(mesh.quads, 0, slot);
+
+  m_Slots[slot].lod = mesh.lod;
+  m_Slots[slot].regions = mesh.regions;
+  m_RangesDirty = true;
+}
+
+void ChunkSlots::release(const glm::ivec3 &coord) {
+  auto it = m_Chunks.find(coord);
+
+  if (it == m_Chunks.end())
+    return;
+
+  m_Slots[it->second].used = false;
+  m_Slots[it->second].regions.clear();
+  m_Free.push_back(it->second);
+
+  m_Chunks.erase(it);
+  m_RangesDirty = true;
+}
+
+const std::vector<ChunkRange> &ChunkSlots::getRanges() {
+  if (!m_RangesDirty)
+    return m_Ranges;
+
+  m_Ranges.clear();
+
+  /**
+   * Partitions are laid out in order, growing one moves every partition after
+   * it, so the offsets are summed again after any upload.
+   */
+  size_t offset = 0;
+
+  for (unsigned int i = 0; i < m_Slots.size(); i++) {
+    int first = static_cast<int>(offset / sizeof(PackedQuad));
+
+    for (size_t region = 0; region < m_Slots[i].regions.size(); region++) {
+      const int count = m_Slots[i].regions[region];
+
+      if (count)
+        m_Ranges.push_back({m_Slots[i].coord, static_cast<int>(region),
+                            m_Slots[i].lod, first, count});
+
+      first += count;
+    }
+
+    offset += m_Buffer->getBufferPartitionSize(i);
+  }
+
+  m_RangesDirty = false;
+
+  return m_Ranges;
+}
+
+Buffer *ChunkSlots::getBuffer() const { return m_Buffer; }
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+#include "Engine/Core/Buffer.h"
+#include "Engine/Types.h"
+#include "Voxel/Common.h"
+
+#include "Components.h"
+
+namespace Raster {
+
+/**
+ * Gives every chunk it's own partition of one persistent vertex buffer.
+ *
+ * Uploading a chunk only writes that chunk's quads into it's partition. A
+ * partition that is too small grows in place, the buffer is copied on the GPU
+ * and the partitions after it move, nothing else is uploaded again. A chunk
+ * that is released keeps it's partition as a free slot for the next chunk.
+ *
+ * Resizing replaces the buffer object, so the vertex attributes must be set
+ * again whenever getBuffer()->get() changes.
+ *
+ * Example usage:
+ *
+ *   Buffer buffer{BufferTarget::ARRAY_BUFFER, 1, VertexDraw::DYNAMIC};
+ *   ChunkSlots slots(&buffer);
+ *
+ *   buffer.bind();
+ *   slots.upload(coord, mesh);
+ *
+ *   for (const ChunkRange &range : slots.getRanges())
+ *     ...
+ */
+class ChunkSlots {
+private:
+  struct Slot {
+    glm::ivec3 coord;
+    int lod = 0;
+    bool used = false;
+
+    /**
+     * The number of quads of each region, see ChunkMesh.
+     */
+    std::vector<int> regions;
+  };
+
+private:
+  Buffer *m_Buffer = nullptr;
+
+  /**
+   * Slot i is partition i of the buffer.
+   */
+  std::vector<Slot> m_Slots;
+  std::vector<unsigned int> m_Free;
+  std::unordered_map<glm::ivec3, unsigned int> m_Chunks;
+
+  bool m_RangesDirty = false;
+  std::vector<ChunkRange> m_Ranges;
+
+public:
+  ChunkSlots(Buffer *buffer);
+
+  ChunkSlots(const ChunkSlots &) = delete;
+  ChunkSlots &operator=(const ChunkSlots &) = delete;
+
+  /**
+   * Replaces the quads of the chunk, the buffer must be bound. A chunk
+   * without quads gives up it's slot.
+   */
+  void upload(const glm::ivec3 &coord, const ChunkMesh &mesh);
+
+  /**
+   * Frees the slot of the chunk, it's quads are no longer drawn.
+   */
+  void release(const glm::ivec3 &coord);
+
+  /**
+   * The quads of every region with quads of every chunk with a slot, first
+   * is in quads from the start of the buffer. The regions of a chunk are
+   * next to each other.
+   */
+  const std::vector<ChunkRange> &getRanges();
+
+  Buffer *getBuffer() const;
+};
+
+} // namespace Raster
@@ -1,70 +1,156 @@
 #pragma once
 
+#include "Engine/Face.h"
 #include "Engine/Types.h"
+#include "Voxel/Common.h"
 #include <array>
 #include <glm/glm.hpp>
 #include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace Raster {
 
-class CVoxelBuffer {
-private:
-  static constexpr uint8_t m_Next[2] = {1, 0};
+/**
+ * The quads of one region of a chunk in the vertex buffer. The quads are
+ * local to the chunk, they are offset by the chunk when drawn. A chunk meshed
+ * at level of detail lod is in 2^lod wide cells, it's quads are scaled by that
+ * when drawn.
+ */
+struct ChunkRange {
+  glm::ivec3 coord;
+  int region;
+  int lod;
+  int first;
+  int count;
+};
+
+/**
+ * The quads of every region of a chunk one after the other, regions[i] is the
+ * number of quads of region i. A chunk without quads has been erased.
+ */
+struct ChunkMesh {
+  int lod = 0;
+  std::vector<PackedQuad> quads;
+  std::vector<int> regions;
+};
 
+class CVoxelBuffer {
 private:
   bool m_Dirty = false;
   std::shared_mutex m_Mutex;
 
-  uint8_t m_Current;
-  std::array<std::vector<Vertex>, 2> m_Buffer;
-  std::unordered_map<glm::ivec3, std::vector<Vertex>> m_ChunkVertices;
+  /**
+   * The quads of every chunk, one vector per region the chunk is meshed in.
+   */
+  std::unordered_map<glm::ivec3, std::vector<std::vector<PackedQuad>>>
+      m_ChunkQuads;
+
+  /**
+   * The level of detail every chunk was last meshed at.
+   */
+  std::unordered_map<glm::ivec3, int> m_LevelsOfDetail;
+
+  /**
+   * The chunks that were set or erased since the last flush.
+   */
+  std::unordered_set<glm::ivec3> m_Pending;
+
+  /**
+   * The quads of every chunk that changed since the last takeChanges().
+   */
+  std::unordered_map<glm::ivec3, ChunkMesh> m_Changes;
 
 public:
   CVoxelBuffer() = default;
 
-  void setVertices(const glm::ivec3 &coord, const std::vector<Vertex> &data) {
+  /**
+   * Replaces the quads of one region of the chunk, the quads of it's other
+   * regions are kept. The region's storage is reused when it is large
+   * enough.
+   *
+   * @param lod  The level of detail the chunk was meshed at, the same for
+   * every region of the chunk.
+   */
+  void setQuads(const glm::ivec3 &coord, int region,
+                const std::vector<PackedQuad> &data, int lod = 0) {
     std::unique_lock lock(m_Mutex);
-    m_ChunkVertices[coord].insert(m_ChunkVertices[coord].begin(),
-                                  std::make_move_iterator(data.begin()),
-                                  std::make_move_iterator(data.end()));
-  }
 
-  const std::vector<Vertex> &getVertices() {
-    std::shared_lock lock(m_Mutex);
-    return m_Buffer[m_Current];
-  }
+    m_LevelsOfDetail[coord] = lod;
 
-  int getSize() const { return static_cast<int>(m_Buffer[m_Current].size()); }
+    std::vector<std::vector<PackedQuad>> &regions = m_ChunkQuads[coord];
 
-  void erase(const glm::ivec3 &coord) {
-    std::unique_lock lock(m_Mutex);
-    if (!m_ChunkVertices.contains(coord))
-      return;
-    m_ChunkVertices.erase(coord);
+    if (static_cast<int>(regions.size()) <= region)
+      regions.resize(region + 1);
+
+    regions[region].assign(data.begin(), data.end());
+    m_Pending.insert(coord);
   }
 
-  void clean() {
+  void erase(const glm::ivec3 &coord) {
     std::unique_lock lock(m_Mutex);
-    m_Dirty = false;
+    if (!m_ChunkQuads.contains(coord))
+      return;
+    m_ChunkQuads.erase(coord);
+    m_LevelsOfDetail.erase(coord);
+    m_Pending.insert(coord);
   }
 
+  /**
+   * Publishes the chunks that changed since the last flush, only their
+   * quads are copied.
+   */
   void flush() {
     std::unique_lock lock(m_Mutex);
+
+    if (m_Pending.empty())
+      return;
+
     m_Dirty = true;
 
-    m_Buffer[m_Next[m_Current]].clear();
+    /**
+     * The regions of a chunk share it's slot, they are kept apart so each
+     * one can be culled on it's own.
+     */
+    for (const glm::ivec3 &coord : m_Pending) {
+      ChunkMesh &mesh = m_Changes[coord];
+      mesh.quads.clear();
+      mesh.regions.clear();
+
+      auto it = m_ChunkQuads.find(coord);
+
+      if (it == m_ChunkQuads.end())
+        continue;
 
-    for (auto &[k, v] : m_ChunkVertices)
-      m_Buffer[m_Next[m_Current]].insert(m_Buffer[m_Next[m_Current]].end(),
-                                         v.begin(), v.end());
+      mesh.lod = m_LevelsOfDetail[coord];
 
-    m_Current = m_Next[m_Current];
+      for (const std::vector<PackedQuad> &region : it->second) {
+        mesh.quads.insert(mesh.quads.end(), region.begin(), region.end());
+        mesh.regions.push_back(static_cast<int>(region.size()));
+      }
+    }
 
-    m_Buffer[m_Next[m_Current]].clear();
+    m_Pending.clear();
   }
 
-  bool isDirty() { return m_Dirty; }
+  /**
+   * Moves the published changes into changes, replacing what it held.
+   */
+  void takeChanges(std::unordered_map<glm::ivec3, ChunkMesh> &changes) {
+    std::unique_lock lock(m_Mutex);
+
+    changes = std::move(m_Changes);
+    m_Changes.clear();
+
+    m_Dirty = false;
+  }
+
+  bool isDirty() {
+    std::shared_lock lock(m_Mutex);
+    return m_Dirty;
+  }
 };
 
 } // namespace Raster
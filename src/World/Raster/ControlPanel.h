@@ -38,6 +38,9 @@ private:
 
   glm::vec2 m_Mouse;
 
+  glm::ivec3 m_EditPosition{0, 64, 0};
+  int m_EditVoxel = 0;
+
 public:
   Light light;
   Material material;
@@ -62,6 +65,33 @@ public:
     if (ImGui::Button("Recompile shaders"))
       m_Resource->getShader().recompile();
 
+    ImGui::SeparatorText("Chunks");
+
+    VoxelManager &voxels = m_World->getVoxels();
+
+    int chunkRadius = voxels.getChunkRadius();
+    if (ImGui::SliderInt("Chunk radius", &chunkRadius, 1,
+                         voxels.getMaxChunkRadius()))
+      voxels.setChunkRadius(chunkRadius);
+
+    bool levelOfDetail = voxels.isLevelOfDetail();
+    if (ImGui::Checkbox("Level of detail", &levelOfDetail))
+      voxels.setLevelOfDetail(levelOfDetail);
+
+    ImGui::SeparatorText("Edit");
+
+    ImGui::DragInt3("Voxel position", &m_EditPosition.x);
+    ImGui::SliderInt("Voxel", &m_EditVoxel, 0,
+                     static_cast<int>(voxels.getPalette().size()) - 1);
+
+    if (ImGui::Button("Camera position"))
+      m_EditPosition = glm::ivec3(glm::floor(m_Camera->position));
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("Set voxel"))
+      voxels.setVoxel(m_EditPosition, static_cast<VoxelID>(m_EditVoxel));
+
     ImGui::SeparatorText("Terrain");
 
     if (ImGui::TreeNode("Draw mode")) {
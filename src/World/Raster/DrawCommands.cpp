@@ -0,0 +1,103 @@
+#include "DrawCommands.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "Engine/Face.h"
+
+using namespace Raster;
+
+void DrawCommands::clear() {
+  m_Commands.clear();
+  m_Offsets.clear();
+}
+
+void DrawCommands::add(const ChunkRange &range, const glm::ivec3 &offset) {
+  if (range.count <= 0)
+    return;
+
+  /**
+   * The quad indices are the same for every chunk, the base instance skips
+   * to the chunk's first quad.
+   */
+  DrawElementsIndirectCommand command;
+  command.count = static_cast<unsigned int>(std::size(Face::QUAD_INDICES));
+  command.primCount = static_cast<unsigned int>(range.count);
+  command.firstIndex = 0;
+  command.baseVertex = 0;
+  command.baseInstance = static_cast<unsigned int>(range.first);
+
+  m_Commands.push_back(command);
+  m_Offsets.emplace_back(offset, 1 << range.lod);
+}
+
+void DrawCommands::addVisible(const std::vector<ChunkRange> &ranges,
+                              const Frustum &frustum, int chunkSize,
+                              int regionSize) {
+  const int regionsPerAxis = chunkSize / regionSize;
+
+  /**
+   * One box per chunk, a chunk starts where the coord changes.
+   */
+  m_Boxes.clear();
+
+  for (size_t i = 0; i < ranges.size(); i++) {
+    if (i > 0 && ranges[i].coord == ranges[i - 1].coord)
+      continue;
+
+    const glm::vec3 min = ranges[i].coord * chunkSize;
+    m_Boxes.push(min, min + static_cast<float>(chunkSize));
+  }
+
+  frustum.cull(m_Boxes, m_Visible);
+
+  /**
+   * One box per region of the chunks that are left.
+   */
+  m_Boxes.clear();
+  m_Candidates.clear();
+
+  size_t chunk = 0;
+
+  for (size_t i = 0; i < ranges.size(); i++) {
+    if (i > 0 && ranges[i].coord != ranges[i - 1].coord)
+      chunk++;
+
+    if (!m_Visible[chunk])
+      continue;
+
+    const int region = ranges[i].region;
+    const glm::ivec3 origin(region % regionsPerAxis,
+                            (region / regionsPerAxis) % regionsPerAxis,
+                            region / (regionsPerAxis * regionsPerAxis));
+
+    /**
+     * A region of a coarser level covers 2^lod times as many voxels, up to
+     * the whole chunk.
+     */
+    const int size = std::min(regionSize << ranges[i].lod, chunkSize);
+
+    const glm::vec3 min = ranges[i].coord * chunkSize + origin * size;
+    m_Boxes.push(min, min + static_cast<float>(size));
+    m_Candidates.push_back(i);
+  }
+
+  frustum.cull(m_Boxes, m_Visible);
+
+  for (size_t i = 0; i < m_Candidates.size(); i++)
+    if (m_Visible[i])
+      add(ranges[m_Candidates[i]], ranges[m_Candidates[i]].coord * chunkSize);
+}
+
+const std::vector<DrawElementsIndirectCommand> &
+DrawCommands::getCommands() const {
+  return m_Commands;
+}
+
+const std::vector<glm::ivec4> &DrawCommands::getOffsets() const {
+  return m_Offsets;
+}
+
+size_t DrawCommands::size() const { return m_Commands.size(); }
+
+bool DrawCommands::empty() const { return m_Commands.empty(); }
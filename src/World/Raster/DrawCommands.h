@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Engine/Camera/Frustum.h"
+#include "Engine/Types.h"
+
+#include "Components.h"
+
+namespace Raster {
+
+/**
+ * Builds the commands to draw every chunk with one
+ * glMultiDrawElementsIndirect.
+ *
+ * Each chunk is one command, it's quads are instances of the 6 quad indices
+ * starting at the chunk's first quad. The offset of command i's chunk is
+ * offsets[i], raster.vs reads it with gl_DrawIDARB. No GL calls are made
+ * here, uploading the commands & offsets is up to the caller.
+ *
+ * Example usage:
+ *
+ *   DrawCommands commands;
+ *
+ *   commands.clear();
+ *   commands.addVisible(ranges, camera.getFrustum(), 128, 64);
+ *
+ *   indirect.set(commands.getCommands());
+ *   offsets.set(commands.getOffsets());
+ */
+class DrawCommands {
+private:
+  std::vector<DrawElementsIndirectCommand> m_Commands;
+
+  /**
+   * One per command, the chunk's origin and in w the size of a cell of it's
+   * level of detail. ivec4 to match the std430 array stride of an ivec3.
+   */
+  std::vector<glm::ivec4> m_Offsets;
+
+  /**
+   * Scratch state for addVisible(), kept so culling does not allocate.
+   */
+  AABBList m_Boxes;
+  std::vector<uint8_t> m_Visible;
+  std::vector<size_t> m_Candidates;
+
+public:
+  /**
+   * Removes every command, the storage is kept.
+   */
+  void clear();
+
+  /**
+   * Adds the command to draw the chunk, chunks without quads are skipped.
+   *
+   * @param range   The quads of the chunk in the vertex buffer.
+   * @param offset  The world position of the chunk's origin.
+   */
+  void add(const ChunkRange &range, const glm::ivec3 &offset);
+
+  /**
+   * Adds the commands of the ranges that may be inside the frustum.
+   *
+   * Whole chunks are culled first, the regions of the chunks that are left
+   * are then culled on their own. Both passes test their boxes in one batch.
+   *
+   * @param ranges      The regions of every chunk, the regions of a chunk
+   * next to each other, see ChunkSlots::getRanges().
+   * @param chunkSize   The side length of a chunk.
+   * @param regionSize  The side length of a region, chunkSize must be a
+   * multiple of it.
+   */
+  void addVisible(const std::vector<ChunkRange> &ranges,
+                  const Frustum &frustum, int chunkSize, int regionSize);
+
+  const std::vector<DrawElementsIndirectCommand> &getCommands() const;
+
+  const std::vector<glm::ivec4> &getOffsets() const;
+
+  /**
+   * Returns the number of commands.
+   */
+  size_t size() const;
+
+  bool empty() const;
+};
+
+} // namespace Raster
@@ -1,41 +1,44 @@
 #include "VoxelManager.h"
+#include <algorithm>
+#include <execution>
 #include <future>
 #include <iostream>
 #include <mutex>
 #include <noise/noiseutils.h>
+#include <numeric>
 #include <unordered_set>
 
 #include "Components.h"
 #include "Debug.h"
-#include "Voxel/GreedyMesh64.h"
 
 using namespace Raster;
 
 VoxelManager::~VoxelManager() {
-  for (Voxel *voxel : m_VoxelPalette)
-    delete voxel;
-
   for (auto &[coord, tree] : m_Chunks)
     delete tree;
 }
 
 void VoxelManager::initialize(const glm::vec3 &position) {
   m_PlayerChunkPosition = getChunkPosition(position);
+  m_LoadedRadius = m_ChunkRadius.load();
   generateTerrain(getChunkPositionsInRadius(getChunkPosition(position)));
 }
 
 void VoxelManager::update(const glm::vec3 &position) {
-  return;
   const glm::ivec3 currentChunkPosition = getChunkPosition(position);
+  const int radius = m_ChunkRadius;
 
-  if (m_PlayerChunkPosition == currentChunkPosition)
+  if (m_PlayerChunkPosition == currentChunkPosition && m_LoadedRadius == radius)
     return;
 
-  std::thread([this, currentChunkPosition]() {
+  std::thread([this, currentChunkPosition, radius]() {
     if (!m_UpdateMutex.try_lock())
       return;
 
+    const glm::ivec3 previousChunkPosition = m_PlayerChunkPosition;
+
     m_PlayerChunkPosition = currentChunkPosition;
+    m_LoadedRadius = radius;
 
     std::vector<glm::ivec3> create =
         getChunkPositionsInRadius(currentChunkPosition);
@@ -59,46 +62,66 @@ void VoxelManager::update(const glm::vec3 &position) {
       for (const auto &coord : remove)
         voxelBuffer->erase(coord);
 
-    m_UpdateMutex.unlock();
+    /**
+     * The chunks that stay are only meshed again if the player moved them
+     * into another ring of detail.
+     */
+    std::vector<glm::ivec3> mesh;
+
+    for (const auto &[coord, tree] : m_Chunks)
+      if (getLevelOfDetail(coord, previousChunkPosition) !=
+          getLevelOfDetail(coord, currentChunkPosition))
+        mesh.push_back(coord);
 
-    generateTerrain(create);
+    loadChunks(create, mesh);
+
+    m_UpdateMutex.unlock();
   }).detach();
 }
 
 void VoxelManager::generateTerrain(const std::vector<glm::ivec3> &coords) {
-  std::thread([this, coords = coords,
-               m_Futures = std::move(m_Futures)]() mutable {
+  std::thread([this, coords = coords]() {
     if (!m_UpdateMutex.try_lock())
       return;
 
-    auto t1 = START_TIMER;
+    loadChunks(coords, {});
 
-    for (const auto &coord : coords)
-      m_Futures.push_back(std::async(
-          std::launch::async, &VoxelManager::generateChunk, this, coord));
+    m_UpdateMutex.unlock();
+  }).detach();
+}
 
-    for (auto &f : m_Futures)
-      f.get();
+void VoxelManager::loadChunks(const std::vector<glm::ivec3> &generate,
+                              const std::vector<glm::ivec3> &mesh) {
+  auto t1 = START_TIMER;
 
-    m_Futures.clear();
+  for (const auto &coord : generate)
+    m_Futures.push_back(std::async(std::launch::async,
+                                   &VoxelManager::generateChunk, this, coord));
 
-    for (const auto &coord : coords)
-      m_Futures.push_back(std::async(std::launch::async,
-                                     &VoxelManager::meshChunk, this, coord));
+  for (auto &f : m_Futures)
+    f.get();
 
-    for (auto &f : m_Futures)
-      f.get();
+  m_Futures.clear();
 
-    for (CVoxelBuffer *voxelBuffer : m_Registry->get<CVoxelBuffer>())
-      voxelBuffer->flush();
+  for (const auto &coord : generate)
+    m_Futures.push_back(std::async(std::launch::async,
+                                   &VoxelManager::meshChunk, this, coord));
 
-    m_Futures.clear();
+  for (const auto &coord : mesh)
+    m_Futures.push_back(std::async(std::launch::async,
+                                   &VoxelManager::meshChunk, this, coord));
 
-    LOG("Chunks", coords.size());
-    END_TIMER(t1);
+  for (auto &f : m_Futures)
+    f.get();
 
-    m_UpdateMutex.unlock();
-  }).detach();
+  for (CVoxelBuffer *voxelBuffer : m_Registry->get<CVoxelBuffer>())
+    voxelBuffer->flush();
+
+  m_Futures.clear();
+
+  LOG("Chunks", generate.size());
+  LOG("Meshed again", mesh.size());
+  END_TIMER(t1);
 }
 
 void VoxelManager::generateChunk(const glm::ivec3 &coord) {
@@ -116,34 +139,35 @@ void VoxelManager::generateChunk(const glm::ivec3 &coord) {
 
   SparseVoxelOctree *tree = m_Chunks.at(coord);
 
-  tree->clear();
-
   utils::NoiseMap map = m_HeightMap->build(coord.x, coord.x + s_HeightMapStep,
                                            coord.z, coord.z + s_HeightMapStep);
 
-  auto generateBlockChunks = [&](int thresholdFrom, int thresholdTo,
-                                 Voxel *voxel) mutable {
-    uint64_t mask[(s_ChunkSize * s_ChunkSize) * (s_ChunkSize / 64)] = {0};
-
-    for (int z = 0; z < s_ChunkSize; z++)
-      for (int x = 0; x < s_ChunkSize; x++) {
-        float n = map.GetValue(x, z);
-        int height = static_cast<int>(
-            std::round((std::clamp(n, -1.0f, 1.0f) + 1) * (s_ChunkSize / 2)));
-        for (int y = 0; y < height; y++) {
-          int index = x + s_ChunkSize * (z + s_ChunkSize * y);
-          if (y >= thresholdFrom && y < thresholdTo)
-            mask[index / 64] |= 1ULL << (index % 64);
-        }
-      }
-
-    tree->set(mask, voxel);
+  /**
+   * Every layer of the terrain is written into one grid of palette ids, the
+   * tree is then built from it in a single pass.
+   */
+  static constexpr std::tuple<int, int, VoxelID> layers[] = {
+      {0, 16, VoxelPalette::STONE},
+      {16, 24, VoxelPalette::DIRT},
+      {24, 64, VoxelPalette::GRASS},
+      {64, 128, VoxelPalette::SNOW},
   };
 
-  generateBlockChunks(0, 16, m_VoxelPalette[VoxelPalette::STONE]);
-  generateBlockChunks(16, 24, m_VoxelPalette[VoxelPalette::DIRT]);
-  generateBlockChunks(24, 64, m_VoxelPalette[VoxelPalette::GRASS]);
-  generateBlockChunks(64, 128, m_VoxelPalette[VoxelPalette::SNOW]);
+  static thread_local std::vector<VoxelID> voxels;
+  voxels.assign(s_ChunkSize * s_ChunkSize * s_ChunkSize, EMPTY_VOXEL);
+
+  for (int z = 0; z < s_ChunkSize; z++)
+    for (int x = 0; x < s_ChunkSize; x++) {
+      float n = map.GetValue(x, z);
+      int height = static_cast<int>(
+          std::round((std::clamp(n, -1.0f, 1.0f) + 1) * (s_ChunkSize / 2)));
+
+      for (const auto &[thresholdFrom, thresholdTo, voxel] : layers)
+        for (int y = thresholdFrom; y < std::min(height, thresholdTo); y++)
+          voxels[x + s_ChunkSize * (z + s_ChunkSize * y)] = voxel;
+    }
+
+  tree->build(voxels.data());
 
   END_TIMER(t1);
 }
@@ -158,38 +182,206 @@ void VoxelManager::meshChunk(const glm::ivec3 &coord) {
 
   auto t1 = START_TIMER;
 
-  it->second->setNeighbours(coord, m_Chunks);
+  SparseVoxelOctree *tree = it->second;
 
-  for (size_t i = 0; i < m_VoxelPalette.size(); i++) {
-    std::vector<Vertex> vertices;
+  tree->setNeighbours(coord, m_Chunks);
 
-    const int chunkSize = GreedyMesh64::CHUNK_SIZE;
-    const int chunksPerAxis = std::max(1, it->second->getSize() / chunkSize);
+  /**
+   * Cleared first, a region a neighbour's edit marks while this chunk is
+   * meshed is meshed again by it's meshDirtyRegions().
+   */
+  tree->clearDirtyRegions();
 
-    for (int cz = 0; cz < chunksPerAxis; cz++)
-      for (int cy = 0; cy < chunksPerAxis; cy++)
-        for (int cx = 0; cx < chunksPerAxis; cx++)
-          GreedyMesh64::Octree(it->second, vertices, cx * chunkSize,
-                               cy * chunkSize, cz * chunkSize,
-                               m_VoxelPalette[i]);
+  if (const int lod = getLevelOfDetail(coord))
+    meshCoarse(coord, tree, lod);
+  else {
+    std::array<int, s_RegionCount> regions;
+    std::iota(regions.begin(), regions.end(), 0);
 
-    Voxel *filter = m_VoxelPalette[i];
+    meshRegions(coord, tree, regions);
+  }
 
-    for (size_t j = 0; j < vertices.size(); j++) {
-      vertices[j].x += static_cast<float>(coord.x * s_ChunkSize);
-      vertices[j].y += static_cast<float>(coord.y * s_ChunkSize);
-      vertices[j].z += static_cast<float>(coord.z * s_ChunkSize);
-      vertices[j].color = filter->color;
-      vertices[j].material = filter->material;
-    }
+  END_TIMER(t1);
+}
 
-    for (CVoxelBuffer *voxelBuffer : m_Registry->get<CVoxelBuffer>())
-      voxelBuffer->setVertices(coord, vertices);
+void VoxelManager::meshRegions(const glm::ivec3 &coord,
+                               SparseVoxelOctree *tree,
+                               std::span<const int> regions) {
+  /**
+   * Every region is meshed as it's own task into it's own output, so
+   * re-meshing a single chunk uses every core. Most tasks run on the worker
+   * threads of the parallel algorithms, which live as long as the app and
+   * keep their contexts. The short lived thread of the chunk makes a new
+   * one, which costs no more than reusing one, see GreedyMeshBenchmark.
+   */
+  MeshOutput *output = m_MeshOutputs.acquire();
+
+  const int regionSize = Mesher::CHUNK_SIZE;
+
+  /**
+   * Every material is meshed in the same pass, the quads come back tagged
+   * with their palette id. They stay local to the chunk, the chunk offset is
+   * added when they are drawn.
+   */
+  std::for_each(std::execution::par, regions.begin(), regions.end(),
+                [&](int region) {
+                  const int rx = region % s_RegionsPerAxis;
+                  const int ry = (region / s_RegionsPerAxis) % s_RegionsPerAxis;
+                  const int rz = region / (s_RegionsPerAxis * s_RegionsPerAxis);
+
+                  std::vector<PackedQuad> &quads = output->regions[region];
+                  quads.clear();
+
+                  Mesher::Octree(tree, m_Palette, quads, rx * regionSize,
+                                 ry * regionSize, rz * regionSize);
+                });
+
+  for (CVoxelBuffer *voxelBuffer : m_Registry->get<CVoxelBuffer>())
+    for (int region : regions)
+      voxelBuffer->setQuads(coord, region, output->regions[region]);
+
+  m_MeshOutputs.release(output);
+}
+
+void VoxelManager::meshCoarse(const glm::ivec3 &coord, SparseVoxelOctree *tree,
+                              int lod) {
+  MeshOutput *output = m_MeshOutputs.acquire();
+
+  for (std::vector<PackedQuad> &quads : output->regions)
+    quads.clear();
+
+  Mesher::Octree(tree, m_Palette, output->regions[0], 0, 0, 0, lod);
+
+  for (CVoxelBuffer *voxelBuffer : m_Registry->get<CVoxelBuffer>())
+    for (int region = 0; region < s_RegionCount; region++)
+      voxelBuffer->setQuads(coord, region, output->regions[region], lod);
+
+  m_MeshOutputs.release(output);
+}
+
+void VoxelManager::meshDirtyRegions(const glm::ivec3 &coord) {
+  std::shared_lock lock(m_Mutex.get(coord));
+
+  auto it = m_Chunks.find(coord);
+
+  if (it == m_Chunks.end() || it->second == nullptr)
+    return;
+
+  SparseVoxelOctree *tree = it->second;
+
+  const std::vector<glm::ivec3> dirty = tree->takeDirtyRegions();
+
+  if (dirty.empty())
+    return;
+
+  tree->setNeighbours(coord, m_Chunks);
+
+  if (const int lod = getLevelOfDetail(coord))
+    return meshCoarse(coord, tree, lod);
+
+  const int regionSize = Mesher::CHUNK_SIZE;
+
+  std::array<int, s_RegionCount> regions;
+  size_t count = 0;
+
+  for (const glm::ivec3 &origin : dirty)
+    regions[count++] =
+        (origin.x / regionSize) +
+        s_RegionsPerAxis * ((origin.y / regionSize) +
+                            s_RegionsPerAxis * (origin.z / regionSize));
+
+  meshRegions(coord, tree, std::span<const int>(regions.data(), count));
+}
+
+void VoxelManager::setVoxel(const glm::ivec3 &position, VoxelID voxel) {
+  std::lock_guard updateLock(m_UpdateMutex);
+
+  auto t1 = START_TIMER;
+
+  const glm::ivec3 coord = getChunkPosition(position);
+
+  {
+    std::unique_lock lock(m_Mutex.get(coord));
+
+    auto it = m_Chunks.find(coord);
+
+    if (it == m_Chunks.end() || it->second == nullptr)
+      return;
+
+    /**
+     * The tree marks the regions the edit touches, including the ones in
+     * the chunks next to it.
+     */
+    it->second->setNeighbours(coord, m_Chunks);
+
+    const glm::ivec3 local = position - coord * s_ChunkSize;
+    it->second->set(local.x, local.y, local.z, voxel);
   }
 
+  static constexpr glm::ivec3 chunks[] = {{0, 0, 0},  {-1, 0, 0}, {1, 0, 0},
+                                          {0, -1, 0}, {0, 1, 0},  {0, 0, -1},
+                                          {0, 0, 1}};
+
+  for (const glm::ivec3 &offset : chunks)
+    meshDirtyRegions(coord + offset);
+
+  for (CVoxelBuffer *voxelBuffer : m_Registry->get<CVoxelBuffer>())
+    voxelBuffer->flush();
+
   END_TIMER(t1);
 }
 
+const Palette &VoxelManager::getPalette() const { return m_Palette; }
+
+int VoxelManager::getLevelOfDetail(const glm::ivec3 &coord) const {
+  return getLevelOfDetail(coord, m_PlayerChunkPosition);
+}
+
+int VoxelManager::getLevelOfDetail(const glm::ivec3 &coord,
+                                   const glm::ivec3 &center) const {
+  if (!m_LevelOfDetail)
+    return 0;
+
+  const glm::ivec3 distance = glm::abs(coord - center);
+  const int ring = std::max(distance.x, std::max(distance.y, distance.z));
+
+  if (ring <= s_NearRadius)
+    return 0;
+
+  return std::min(1 + (ring - s_NearRadius - 1) / s_LodRingWidth, s_MaxLod);
+}
+
+void VoxelManager::setLevelOfDetail(bool enabled) {
+  if (m_LevelOfDetail.exchange(enabled) == enabled)
+    return;
+
+  /**
+   * Waits for the terrain being generated, the chunks it meshes after this
+   * already use the new setting but the ones before do not.
+   */
+  std::thread([this]() {
+    std::lock_guard lock(m_UpdateMutex);
+
+    std::vector<std::future<void>> futures;
+
+    for (const auto &[coord, tree] : m_Chunks)
+      futures.push_back(std::async(std::launch::async,
+                                   &VoxelManager::meshChunk, this, coord));
+
+    for (auto &f : futures)
+      f.get();
+
+    for (CVoxelBuffer *voxelBuffer : m_Registry->get<CVoxelBuffer>())
+      voxelBuffer->flush();
+  }).detach();
+}
+
+bool VoxelManager::isLevelOfDetail() const { return m_LevelOfDetail; }
+
+int VoxelManager::getChunkSize() const { return s_ChunkSize; }
+
+int VoxelManager::getRegionSize() const { return Mesher::CHUNK_SIZE; }
+
 void VoxelManager::setHeightMap(HeightMap *heightMap) {
   m_HeightMap = heightMap;
 }
@@ -201,14 +393,25 @@ void VoxelManager::setRegistry(Registry *registry) {
 
 const std::vector<glm::ivec3>
 VoxelManager::getChunkPositionsInRadius(const glm::ivec3 &center) const {
+  const int chunkRadius = m_ChunkRadius;
+  const glm::ivec3 radius{chunkRadius, 0, chunkRadius};
+
   std::vector<glm::ivec3> result;
-  for (int dz = -s_ChunkRadius.z; dz <= s_ChunkRadius.z; dz++)
-    for (int dx = -s_ChunkRadius.x; dx <= s_ChunkRadius.x; dx++)
-      for (int dy = -s_ChunkRadius.y; dy <= s_ChunkRadius.y; dy++)
+  for (int dz = -radius.z; dz <= radius.z; dz++)
+    for (int dx = -radius.x; dx <= radius.x; dx++)
+      for (int dy = -radius.y; dy <= radius.y; dy++)
         result.emplace_back(center.x + dx, center.y + dy, center.z + dz);
   return result;
 }
 
+void VoxelManager::setChunkRadius(int radius) {
+  m_ChunkRadius = std::clamp(radius, 1, s_MaxChunkRadius);
+}
+
+int VoxelManager::getChunkRadius() const { return m_ChunkRadius; }
+
+int VoxelManager::getMaxChunkRadius() const { return s_MaxChunkRadius; }
+
 const glm::ivec3
 VoxelManager::getChunkPosition(const glm::vec3 &position) const {
   return {static_cast<int>(
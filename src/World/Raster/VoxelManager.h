@@ -1,32 +1,83 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <future>
 #include <glm/glm.hpp>
+#include <span>
 #include <unordered_map>
 
 #include "ECS/Entity.h"
 
 #include "Voxel/Common.h"
+#include "Voxel/GreedyMesh.h"
 #include "Voxel/HeightMap.h"
+#include "Voxel/Palette.h"
 #include "Voxel/SparseVoxelOctree.h"
 
 #include "Components.h"
 #include "Utility/IVecMutex.h"
+#include "Utility/ScratchPool.h"
 
 namespace Raster {
 
 class VoxelManager {
-  enum VoxelPalette {
-    STONE = 0,
-    DIRT = 1,
-    GRASS = 2,
-    SNOW = 3,
+  enum VoxelPalette : VoxelID {
+    STONE = 1,
+    DIRT = 2,
+    GRASS = 3,
+    SNOW = 4,
   };
 
 private:
   static constexpr int s_ChunkSize = 128;
   static constexpr double s_HeightMapStep = 1.0f;
-  static constexpr glm::ivec3 s_ChunkRadius = glm::ivec3{1, 0, 1};
+
+  /**
+   * The largest number of chunks loaded on every side of the player, the
+   * terrain is one chunk high.
+   */
+  static constexpr int s_MaxChunkRadius = 8;
+
+  static_assert(s_ChunkSize <= 128, "Packed quads store 7 bit positions");
+
+  /**
+   * The width of the regions a chunk is meshed in. GreedyMesh<128> meshes a
+   * whole chunk in one call, but with the masks of every palette id it's
+   * working set is several MiB and 64 wide regions are faster. Edits are
+   * tracked per 64^3 dirty region, so a single edit re-meshes only the
+   * regions it touches instead of the whole chunk.
+   */
+  using Mesher = GreedyMesh<64>;
+
+  static_assert(s_ChunkSize % Mesher::CHUNK_SIZE == 0,
+                "A chunk is a whole number of regions");
+  static_assert(Mesher::CHUNK_SIZE == SparseVoxelOctree::DIRTY_REGION_SIZE,
+                "Edits are tracked in the regions that are meshed");
+
+  /**
+   * The chunk of the player and the s_NearRadius rings around it are meshed
+   * at full detail. Chunks further away are meshed from coarser levels of
+   * their tree, the detail halves every s_LodRingWidth rings up to 2^s_MaxLod
+   * wide cells. A coarse chunk must fit in one region of cells.
+   */
+  static constexpr int s_NearRadius = 1;
+  static constexpr int s_LodRingWidth = 1;
+  static constexpr int s_MaxLod = 3;
+
+  static_assert(s_ChunkSize <= Mesher::CHUNK_SIZE * 2,
+                "A coarse chunk is meshed as one region");
+
+  static constexpr int s_RegionsPerAxis = s_ChunkSize / Mesher::CHUNK_SIZE;
+  static constexpr int s_RegionCount =
+      s_RegionsPerAxis * s_RegionsPerAxis * s_RegionsPerAxis;
+
+  /**
+   * The quads of every region of one meshRegions() call.
+   */
+  struct MeshOutput {
+    std::array<std::vector<PackedQuad>, s_RegionCount> regions;
+  };
 
 private:
   Registry *m_Registry = nullptr;
@@ -37,15 +88,73 @@ private:
 
   glm::ivec3 m_PlayerChunkPosition{0, 0, 0};
 
-  std::vector<Voxel *> m_VoxelPalette = {
-      new Voxel(45, 45, 45, 255), new Voxel(101, 67, 33, 255),
-      new Voxel(34, 139, 34, 255), new Voxel(255, 255, 255, 255)};
+  /**
+   * Set from the UI, the chunks are loaded in it on the next update().
+   */
+  std::atomic<int> m_ChunkRadius = 1;
+
+  /**
+   * The radius the loaded chunks were last streamed in.
+   */
+  std::atomic<int> m_LoadedRadius = 1;
+
+  /**
+   * Read by the mesh tasks, set from the UI.
+   */
+  std::atomic<bool> m_LevelOfDetail = true;
+
+  Palette m_Palette = {Voxel(45, 45, 45, 255), Voxel(101, 67, 33, 255),
+                       Voxel(34, 139, 34, 255), Voxel(255, 255, 255, 255)};
 
   IVecMutex m_Mutex;
   std::mutex m_UpdateMutex;
   std::vector<std::future<void>> m_Futures;
   std::unordered_map<glm::ivec3, SparseVoxelOctree *> m_Chunks;
 
+  /**
+   * Pooled, the chunks are meshed on short lived threads so thread_local
+   * outputs would not be reused. The regions mesh with the context of the
+   * thread they run on, see GreedyMesh::Octree().
+   */
+  ScratchPool<MeshOutput> m_MeshOutputs;
+
+private:
+  /**
+   * Generates and meshes the chunks in generate, then meshes the chunks in
+   * mesh again and flushes the voxel buffers. m_UpdateMutex must be held.
+   */
+  void loadChunks(const std::vector<glm::ivec3> &generate,
+                  const std::vector<glm::ivec3> &mesh);
+
+  /**
+   * Returns the level of detail of the chunk with the player in the chunk at
+   * center, see getLevelOfDetail().
+   */
+  int getLevelOfDetail(const glm::ivec3 &coord,
+                       const glm::ivec3 &center) const;
+
+  /**
+   * Meshes the regions of the chunk, each as it's own task, and replaces
+   * their quads in the voxel buffers. The chunk must be locked.
+   *
+   * @param regions  Region indices, x + r * (y + r * z) where r is
+   * s_RegionsPerAxis.
+   */
+  void meshRegions(const glm::ivec3 &coord, SparseVoxelOctree *tree,
+                   std::span<const int> regions);
+
+  /**
+   * Meshes the whole chunk at a coarser level of detail into it's first
+   * region, the other regions are emptied. The chunk must be locked.
+   */
+  void meshCoarse(const glm::ivec3 &coord, SparseVoxelOctree *tree, int lod);
+
+  /**
+   * Meshes only the regions of the chunk that were edited since it was last
+   * meshed, a coarse chunk is meshed again as a whole.
+   */
+  void meshDirtyRegions(const glm::ivec3 &coord);
+
 public:
   VoxelManager() = default;
   ~VoxelManager();
@@ -56,6 +165,12 @@ public:
 
   void initialize(const glm::vec3 &position);
 
+  /**
+   * Once the player enters another chunk or the radius changed, the chunks
+   * outside the radius are removed and the new ones are generated. The
+   * chunks that moved to another ring are meshed again at their new level of
+   * detail.
+   */
   void update(const glm::vec3 &position);
 
   void generateTerrain(const std::vector<glm::ivec3> &coords);
@@ -64,10 +179,59 @@ public:
 
   void meshChunk(const glm::ivec3 &coord);
 
+  /**
+   * Sets the voxel at the world position, or removes it with EMPTY_VOXEL.
+   *
+   * Only the regions the edit touches are meshed again, in this chunk and
+   * in the chunks next to it if the voxel is on their border.
+   *
+   * Meshing reads the trees of the neighbours without locking them, so the
+   * edit waits for the chunks being loaded or meshed and holds m_UpdateMutex
+   * until it's regions are meshed.
+   */
+  void setVoxel(const glm::ivec3 &position, VoxelID voxel);
+
   const std::vector<glm::ivec3>
   getChunkPositionsInRadius(const glm::ivec3 &center) const;
 
   const glm::ivec3 getChunkPosition(const glm::vec3 &position) const;
+
+  /**
+   * Sets the number of chunks loaded on every side of the player, clamped to
+   * 1 and s_MaxChunkRadius.
+   */
+  void setChunkRadius(int radius);
+
+  int getChunkRadius() const;
+
+  int getMaxChunkRadius() const;
+
+  const Palette &getPalette() const;
+
+  /**
+   * Returns the level of detail the chunk is meshed at, 0 is every voxel and
+   * lod is 2^lod wide cells. The chunks next to the player stay at 0, past
+   * them the detail halves every s_LodRingWidth rings.
+   */
+  int getLevelOfDetail(const glm::ivec3 &coord) const;
+
+  /**
+   * Turns meshing distant chunks at lower detail on or off, every chunk is
+   * meshed again in the background.
+   */
+  void setLevelOfDetail(bool enabled);
+
+  bool isLevelOfDetail() const;
+
+  /**
+   * Returns the side length of a chunk, the packed quads are local to it.
+   */
+  int getChunkSize() const;
+
+  /**
+   * The side length of the regions a chunk is meshed in, see ChunkRange.
+   */
+  int getRegionSize() const;
 };
 
 }; // namespace Raster
\ No newline at end of file
@@ -8,48 +8,88 @@ using namespace Raster;
 World::World() { m_Voxels.setHeightMap(&heightMap); }
 
 void World::initialize() {
-  m_Buffer.generate();
+  m_Vao.generate();
+  m_Quads.generate();
+
+  m_Indirect.generate();
+  m_ChunkOffsets.generate();
+
+  m_Indices.generate();
+  m_Indices.set(std::vector<unsigned int>(std::begin(Face::QUAD_INDICES),
+                                          std::end(Face::QUAD_INDICES)));
+
+  const Palette &palette = m_Voxels.getPalette();
+
+  std::vector<unsigned int> colors(palette.size(), 0);
+  for (size_t i = 1; i < palette.size(); i++)
+    colors[i] = palette.get(static_cast<VoxelID>(i)).color;
+
+  m_Palette.generate();
+  m_Palette.bind();
+  m_Palette.setWidth(static_cast<int>(colors.size()));
+  m_Palette.setHeight(1);
+  m_Palette.setFilter(TextureFilter::NEAREST, TextureFilter::NEAREST);
+  m_Palette.setData(reinterpret_cast<unsigned char *>(colors.data()));
+  m_Palette.setTexture(GL_RGBA8);
+  m_Palette.setData(nullptr);
+  m_Palette.unbind();
 
   heightMap.initialize();
   m_Voxels.initialize(m_Camera->position);
 }
 
-void World::draw() {
-  m_Buffer.bind();
+void World::draw(Shader &shader) {
+  m_Vao.bind();
+  m_Palette.bind(0);
+
+  shader.setUniform1i("colorPalette", 0);
 
   /**
-   * TODO: Eventually we will get a segment fault here because the vertex buffer
-   * has a size limit. The solution is to batch vertices and draw them.
-   * Anyways I'd want to create indices or something so just ignoring this for now
+   * Chunks and regions outside the view are never submitted.
    */
-  for (CVoxelBuffer *voxelBuffer : m_Registry->get<CVoxelBuffer>())
-    glDrawArrays(static_cast<GLenum>(drawMode), 0, voxelBuffer->getSize());
+  m_Commands.clear();
+  m_Commands.addVisible(m_Slots.getRanges(), m_Camera->getFrustum(),
+                        m_Voxels.getChunkSize(), m_Voxels.getRegionSize());
+
+  if (m_Commands.empty())
+    return;
+
+  m_Indirect.set(m_Commands.getCommands());
+  m_ChunkOffsets.set(m_Commands.getOffsets());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_ChunkOffsets.get());
 
-  m_Buffer.sync();
+  glMultiDrawElementsIndirect(static_cast<GLenum>(drawMode), GL_UNSIGNED_INT,
+                              nullptr,
+                              static_cast<GLsizei>(m_Commands.size()), 0);
 }
 
 void World::update() {
   m_Voxels.update(m_Camera->position);
 
   for (CVoxelBuffer *voxelBuffer : m_Registry->get<CVoxelBuffer>()) {
-    if (voxelBuffer->isDirty() || m_Buffer.isDirty()) {
-      const std::vector<Vertex> verticies = voxelBuffer->getVertices();
-      auto [vao, vbo] = m_Buffer.get();
-
-      vao->bind();
-      vbo->set(verticies);
-      vao->set(0, 3, VertexType::FLOAT, false, sizeof(Vertex),
-               (void *)(offsetof(Vertex, x)));
-      vao->set(1, 3, VertexType::FLOAT, false, sizeof(Vertex),
-               (void *)(offsetof(Vertex, nx)));
-      vao->set(2, 1, VertexType::INT, false, sizeof(Vertex),
-               (void *)(offsetof(Vertex, color)));
-      vao->set(3, 1, VertexType::INT, false, sizeof(Vertex),
-               (void *)(offsetof(Vertex, material)));
-
-      voxelBuffer->clean();
-    }
+    if (!voxelBuffer->isDirty())
+      continue;
+
+    voxelBuffer->takeChanges(m_Changes);
+
+    m_Quads.bind();
+
+    for (const auto &[coord, mesh] : m_Changes)
+      m_Slots.upload(coord, mesh);
   }
+
+  if (m_Quads.get() == m_AttributeBuffer)
+    return;
+
+  m_AttributeBuffer = m_Quads.get();
+
+  m_Vao.bind();
+  m_Indices.bind();
+  m_Quads.bind();
+  m_Vao.set(0, 1, VertexType::UNSIGNED_INT, false, sizeof(PackedQuad),
+            (void *)(offsetof(PackedQuad, position)), 1);
+  m_Vao.set(1, 1, VertexType::UNSIGNED_INT, false, sizeof(PackedQuad),
+            (void *)(offsetof(PackedQuad, extent)), 1);
 }
 
 void World::setRegistry(Registry *registry) {
@@ -57,4 +97,6 @@ void World::setRegistry(Registry *registry) {
   m_Voxels.setRegistry(m_Registry);
 }
 
-void World::setCamera(PerspectiveCamera *camera) { m_Camera = camera; }
\ No newline at end of file
+void World::setCamera(PerspectiveCamera *camera) { m_Camera = camera; }
+
+VoxelManager &World::getVoxels() { return m_Voxels; }
\ No newline at end of file
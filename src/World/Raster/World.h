@@ -7,10 +7,12 @@
 
 #include "Engine/Camera/PerspectiveCamera.h"
 #include "Engine/Core/Buffer.h"
-#include "Engine/Core/TripleBuffer.h"
 #include "Engine/Core/VertexArray.h"
+#include "Engine/Shader.h"
 #include "Engine/Texture2D.h"
 
+#include "ChunkSlots.h"
+#include "DrawCommands.h"
 #include "VoxelManager.h"
 
 #include <mutex>
@@ -28,10 +30,45 @@ class World {
 private:
   Registry *m_Registry = nullptr;
 
-  TripleBuffer<BufferTarget::ARRAY_BUFFER, VertexDraw::DYNAMIC> m_Buffer;
+  /**
+   * The quads of every chunk, each chunk in it's own slot so only the chunks
+   * that changed are uploaded. A slot that grows has as much room again.
+   */
+  Buffer m_Quads{BufferTarget::ARRAY_BUFFER, 1, VertexDraw::DYNAMIC};
+  VertexArray m_Vao;
+  ChunkSlots m_Slots{&m_Quads};
+
+  /**
+   * The buffer object the vertex attributes point at, resizing the quad
+   * buffer replaces it.
+   */
+  unsigned int m_AttributeBuffer = 0;
+
+  std::unordered_map<glm::ivec3, ChunkMesh> m_Changes;
+
+  /**
+   * One command per chunk, every chunk is drawn with one
+   * glMultiDrawElementsIndirect. The offset of each chunk is read by
+   * raster.vs from m_ChunkOffsets.
+   */
+  DrawCommands m_Commands;
+  Buffer m_Indirect{BufferTarget::DRAW_INDIRECT_BUFFER, VertexDraw::STREAM};
+  Buffer m_ChunkOffsets{BufferTarget::SHADER_STORAGE_BUFFER,
+                        VertexDraw::STREAM};
+
+  /**
+   * The indices of the two triangles of a quad, shared by every quad.
+   */
+  Buffer m_Indices{BufferTarget::ELEMENT_ARRAY_BUFFER};
 
   VoxelManager m_Voxels;
 
+  /**
+   * The color of every palette id, one texel each. The packed quads only
+   * carry the id, raster.vs looks the color up here.
+   */
+  Texture2D m_Palette;
+
   PerspectiveCamera *m_Camera = nullptr;
 
 public:
@@ -43,13 +80,23 @@ public:
 
   void initialize();
 
-  void draw();
+  /**
+   * Draws every visible region of every chunk in one call, the shader must
+   * be bound. Each region is one indirect command that draws it's quads as
+   * instances.
+   */
+  void draw(Shader &shader);
 
+  /**
+   * Uploads the quads of the chunks that changed into their slots.
+   */
   void update();
 
   void setRegistry(Registry *registry);
 
   void setCamera(PerspectiveCamera *camera);
+
+  VoxelManager &getVoxels();
 };
 
 } // namespace Raster
\ No newline at end of file
@@ -61,6 +61,14 @@ public:
     if (ImGui::Button("Raytrace"))
       m_Registry->get<CTextureBuffer>()[0]->flush();
 
+    ImGui::SeparatorText("Raytracer");
+
+    VoxelManager &voxels = m_World->getVoxels();
+
+    bool packetTracing = voxels.isPacketTracing();
+    if (ImGui::Checkbox("Packet tracing", &packetTracing))
+      voxels.setPacketTracing(packetTracing);
+
     ImGui::SeparatorText("Terrain");
 
     ImGui::SeparatorText("Mesh Generator");
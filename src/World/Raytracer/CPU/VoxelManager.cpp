@@ -2,6 +2,7 @@
 #include <execution>
 #include <future>
 #include <iostream>
+#include <limits>
 #include <mutex>
 #include <noise/noiseutils.h>
 #include <string>
@@ -9,14 +10,11 @@
 
 #include "Components.h"
 #include "Debug.h"
-#include "Voxel/GreedyMesh64.h"
+#include "Voxel/GreedyMesh.h"
 
 using namespace RaytracerCPU;
 
 VoxelManager::~VoxelManager() {
-  for (auto &[voxel, from, to] : m_VoxelPalette)
-    delete voxel;
-
   for (auto &[coord, tree] : m_Chunks)
     delete tree;
 }
@@ -58,6 +56,7 @@ void VoxelManager::update() {
           LOG_IVEC3("deleted", it->first);
           remove.push_back(it->first);
           delete it->second;
+          m_Frozen.erase(it->first);
           it = m_Chunks.erase(it);
         } else {
           create.erase(vit);
@@ -65,6 +64,10 @@ void VoxelManager::update() {
         }
       }
 
+      // Inserted up front, the chunks are generated in parallel.
+      for (const glm::ivec3 &coord : create)
+        m_Frozen[coord];
+
       auto t1 = START_TIMER;
 
       std::for_each(std::execution::par, create.begin(), create.end(),
@@ -101,7 +104,7 @@ void VoxelManager::generateChunk(const glm::ivec3 &coord) {
 
   // std::for_each(
   //     std::execution::par, m_VoxelPalette.begin(), m_VoxelPalette.end(),
-  //     [this, tree, map](std::tuple<Voxel *, int, int> &t) {
+  //     [this, tree, map](std::tuple<VoxelID, int, int> &t) {
   //       auto &[voxel, from, to] = t;
 
   //       uint64_t mask[(s_ChunkSize * s_ChunkSize) * (s_ChunkSize / 64)] =
@@ -128,24 +131,18 @@ void VoxelManager::generateChunk(const glm::ivec3 &coord) {
   auto &[voxel2, from2, to2] = m_VoxelPalette[3];
   tree->set(32, 0, 0, voxel2, 16);
 
+  m_Frozen[coord] = tree->freeze();
+
   END_TIMER(t1);
 }
 
 void VoxelManager::raytrace(const glm::ivec3 &coord) {
-
-  std::unique_lock lock(m_Mutex.get(coord));
-
-  auto it = m_Chunks.find(coord);
-
-  if (it == m_Chunks.end() || it->second == nullptr)
-    return;
-
+  /**
+   * Called with m_UpdateMutex held, chunks are not generated or deleted
+   * while the rays are traced.
+   */
   auto t1 = START_TIMER;
 
-  SparseVoxelOctree *tree = it->second;
-
-  tree->setNeighbours(coord, m_Chunks);
-
   CTextureBuffer *textureBuffer = m_Registry->get<CTextureBuffer>()[0];
 
   textureBuffer->setDimension(m_Camera->viewportWidth,
@@ -154,27 +151,234 @@ void VoxelManager::raytrace(const glm::ivec3 &coord) {
   std::vector<uint32_t> &buffer = textureBuffer->getUpdateBuffer();
 
   const glm::ivec2 &dimension = textureBuffer->getDimension();
-  const std::vector<int> &dx = textureBuffer->getDimensionXIter();
   const std::vector<int> &dy = textureBuffer->getDimensionYIter();
 
+  setRayDirections(dimension, dy);
+  trace(m_Camera->position, coord, dimension, dy, buffer, m_PacketTracing);
+
+  LOG_IVEC3("Raytraced", coord);
+  END_TIMER(t1);
+}
+
+void VoxelManager::setRayDirections(const glm::ivec2 &dimension,
+                                    const std::vector<int> &rows) {
+  m_Directions.resize(dimension.x * dimension.y);
+
+  std::for_each(std::execution::par, rows.begin(), rows.end(), [&](int y) {
+    for (int x = 0; x < dimension.x; x++)
+      m_Directions[x + y * dimension.x] = m_Camera->getRayDirection(x, y);
+  });
+}
+
+void VoxelManager::trace(const glm::vec3 &origin, const glm::ivec3 &center,
+                         const glm::ivec2 &dimension,
+                         const std::vector<int> &rows,
+                         std::vector<uint32_t> &buffer, bool packets) {
   std::for_each(
-      std::execution::par, dy.begin(), dy.end(), [&, dimension](int y) {
-        for (int x = 0; x < dimension.x; x++) {
-          const int i = x + y * dimension.x;
-          const glm::vec3 rayDirection = m_Camera->getRayDirection(x, y);
-          Voxel *hitVoxel = tree->rayTrace(m_Camera->position, rayDirection);
-
-          if (hitVoxel) {
-            buffer[i] = hitVoxel->color;
-          } else
-            buffer[i] = 0x00000000;
+      std::execution::par, rows.begin(), rows.end(), [&](int y) {
+        const glm::vec3 *directions = &m_Directions[y * dimension.x];
+        uint32_t *row = &buffer[y * dimension.x];
+
+        int x = 0;
+
+        if (packets)
+          for (; x + s_PacketSize <= dimension.x; x += s_PacketSize) {
+            glm::vec3 tile[s_PacketSize];
+            RayHit hits[s_PacketSize];
+
+            std::copy(directions + x, directions + x + s_PacketSize, tile);
+
+            const uint8_t hitLanes = rayTrace(origin, tile, center, hits);
+
+            for (int i = 0; i < s_PacketSize; i++)
+              row[x + i] = ((hitLanes >> i) & 1)
+                               ? m_Palette.get(hits[i].voxel).color
+                               : 0x00000000;
+          }
+
+        for (; x < dimension.x; x++) {
+          RayHit hit;
+
+          if (rayTrace(origin, directions[x], center, hit))
+            row[x] = m_Palette.get(hit.voxel).color;
+          else
+            row[x] = 0x00000000;
         }
       });
+}
 
-  LOG_IVEC3("Raytraced", coord);
-  END_TIMER(t1);
+VoxelManager::ChunkWalk
+VoxelManager::startWalk(const glm::vec3 &origin,
+                        const glm::vec3 &direction) const {
+  const float size = static_cast<float>(s_ChunkSize);
+
+  ChunkWalk walk;
+  walk.chunk = getChunkPosition(origin);
+
+  for (int i = 0; i < 3; i++) {
+    if (direction[i] == 0.0f) {
+      walk.step[i] = 0;
+      walk.tNext[i] = walk.tDelta[i] = std::numeric_limits<float>::infinity();
+      continue;
+    }
+
+    walk.step[i] = direction[i] > 0.0f ? 1 : -1;
+    walk.tDelta[i] = size / std::abs(direction[i]);
+
+    const float boundary = (walk.chunk[i] + (walk.step[i] > 0 ? 1 : 0)) * size;
+    walk.tNext[i] = (boundary - origin[i]) / direction[i];
+  }
+
+  return walk;
+}
+
+void VoxelManager::StepWalk(ChunkWalk &walk) {
+  const glm::vec3 &tNext = walk.tNext;
+
+  const int axis = tNext.x < tNext.y ? (tNext.x < tNext.z ? 0 : 2)
+                                     : (tNext.y < tNext.z ? 1 : 2);
+
+  walk.chunk[axis] += walk.step[axis];
+  walk.tNext[axis] += walk.tDelta[axis];
 }
 
+VoxelManager::WalkState VoxelManager::GetWalkState(const ChunkWalk &walk,
+                                                   const glm::ivec3 &center) {
+  WalkState state = WalkState::INSIDE;
+
+  for (int i = 0; i < 3; i++) {
+    const int offset = walk.chunk[i] - center[i];
+
+    if (std::abs(offset) <= s_ChunkRadius[i])
+      continue;
+
+    /**
+     * Outside the radius on this axis, the ray only comes back if it is
+     * heading towards the center.
+     */
+    if (offset * walk.step[i] >= 0)
+      return WalkState::LEFT;
+
+    state = WalkState::OUTSIDE;
+  }
+
+  return state;
+}
+
+const LinearOctree *
+VoxelManager::getTracedChunk(const glm::ivec3 &coord) const {
+  auto it = m_Frozen.find(coord);
+
+  if (it == m_Frozen.end() || it->second.isEmpty())
+    return nullptr;
+
+  return &it->second;
+}
+
+bool VoxelManager::rayTrace(const glm::vec3 &origin,
+                           const glm::vec3 &direction,
+                           const glm::ivec3 &center, RayHit &hit) {
+  const float size = static_cast<float>(s_ChunkSize);
+
+  ChunkWalk walk = startWalk(origin, direction);
+
+  // A zero direction never steps, the walk would not end.
+  if (walk.step == glm::ivec3(0))
+    return false;
+
+  for (;; StepWalk(walk)) {
+    const WalkState state = GetWalkState(walk, center);
+
+    if (state == WalkState::LEFT)
+      return false;
+
+    if (state == WalkState::OUTSIDE)
+      continue;
+
+    const LinearOctree *tree = getTracedChunk(walk.chunk);
+
+    if (tree && tree->rayTrace(origin - glm::vec3(walk.chunk) * size,
+                               direction, hit))
+      return true;
+  }
+}
+
+uint8_t VoxelManager::rayTrace(const glm::vec3 &origin,
+                               const glm::vec3 (&directions)[s_PacketSize],
+                               const glm::ivec3 &center,
+                               RayHit (&hits)[s_PacketSize]) {
+  const float size = static_cast<float>(s_ChunkSize);
+
+  ChunkWalk walks[s_PacketSize];
+
+  uint8_t active = 0;
+  uint8_t hitLanes = 0;
+
+  for (int i = 0; i < s_PacketSize; i++) {
+    walks[i] = startWalk(origin, directions[i]);
+    hits[i] = {};
+
+    if (walks[i].step != glm::ivec3(0))
+      active |= 1 << i;
+  }
+
+  while (active) {
+    uint8_t pending = 0;
+
+    for (int i = 0; i < s_PacketSize; i++) {
+      if (!((active >> i) & 1))
+        continue;
+
+      const WalkState state = GetWalkState(walks[i], center);
+
+      if (state == WalkState::LEFT)
+        active &= ~(1 << i);
+      else if (state == WalkState::INSIDE)
+        pending |= 1 << i;
+    }
+
+    /**
+     * Trace the lanes in the same chunk together, coherent rays usually
+     * all are.
+     */
+    while (pending) {
+      const int lead = __builtin_ctz(pending);
+      const glm::ivec3 chunk = walks[lead].chunk;
+
+      uint8_t lanes = 0;
+
+      for (int i = lead; i < s_PacketSize; i++)
+        if (((pending >> i) & 1) && walks[i].chunk == chunk)
+          lanes |= 1 << i;
+
+      pending &= ~lanes;
+
+      const LinearOctree *tree = getTracedChunk(chunk);
+
+      if (!tree)
+        continue;
+
+      const uint8_t hit = tree->rayTrace(origin - glm::vec3(chunk) * size,
+                                         directions, lanes, hits);
+
+      hitLanes |= hit;
+      active &= ~hit;
+    }
+
+    for (int i = 0; i < s_PacketSize; i++)
+      if ((active >> i) & 1)
+        StepWalk(walks[i]);
+  }
+
+  return hitLanes;
+}
+
+void VoxelManager::setPacketTracing(bool packetTracing) {
+  m_PacketTracing = packetTracing;
+}
+
+bool VoxelManager::isPacketTracing() const { return m_PacketTracing; }
+
 void VoxelManager::setHeightMap(HeightMap *heightMap) {
   m_HeightMap = heightMap;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <future>
 #include <glm/glm.hpp>
 #include <unordered_map>
@@ -10,6 +11,8 @@
 
 #include "Voxel/Common.h"
 #include "Voxel/HeightMap.h"
+#include "Voxel/LinearOctree.h"
+#include "Voxel/Palette.h"
 #include "Voxel/SparseVoxelOctree.h"
 
 #include "Components.h"
@@ -18,17 +21,39 @@
 namespace RaytracerCPU {
 
 class VoxelManager {
-  enum VoxelPalette {
-    STONE = 0,
-    DIRT = 1,
-    GRASS = 2,
-    SNOW = 3,
+  enum VoxelPalette : VoxelID {
+    STONE = 1,
+    DIRT = 2,
+    GRASS = 3,
+    SNOW = 4,
   };
 
 private:
   static constexpr int s_ChunkSize = 128;
   static constexpr double s_HeightMapStep = 1.0f;
-  static constexpr glm::ivec3 s_ChunkRadius = glm::ivec3{0, 0, 0};
+  static constexpr glm::ivec3 s_ChunkRadius = glm::ivec3{1, 0, 1};
+  static constexpr int s_PacketSize = LinearOctree::PACKET_SIZE;
+
+  /**
+   * A 3D DDA over the grid of chunks, see rayTrace().
+   */
+  struct ChunkWalk {
+    glm::ivec3 chunk;
+    glm::ivec3 step;
+
+    /**
+     * The t at which the ray crosses into the next chunk along each axis, and
+     * the t it takes to cross a whole chunk.
+     */
+    glm::vec3 tNext;
+    glm::vec3 tDelta;
+  };
+
+  enum class WalkState {
+    INSIDE,
+    OUTSIDE,
+    LEFT,
+  };
 
 private:
   Registry *m_Registry = nullptr;
@@ -42,11 +67,14 @@ private:
   glm::vec3 m_LastCameraPosition{-999, -999, -999};
   glm::ivec3 m_PlayerChunkPosition{-999, -999, -999};
 
-  std::vector<std::tuple<Voxel *, int, int>> m_VoxelPalette = {
-      std::tuple{new Voxel(45, 45, 45, 255), 0, 16},
-      std::tuple{new Voxel(101, 67, 33, 255), 16, 24},
-      std::tuple{new Voxel(34, 139, 34, 255), 24, 64},
-      std::tuple{new Voxel(255, 255, 255, 255), 64, 128},
+  Palette m_Palette = {Voxel(45, 45, 45, 255), Voxel(101, 67, 33, 255),
+                       Voxel(34, 139, 34, 255), Voxel(255, 255, 255, 255)};
+
+  std::vector<std::tuple<VoxelID, int, int>> m_VoxelPalette = {
+      std::tuple{VoxelPalette::STONE, 0, 16},
+      std::tuple{VoxelPalette::DIRT, 16, 24},
+      std::tuple{VoxelPalette::GRASS, 24, 64},
+      std::tuple{VoxelPalette::SNOW, 64, 128},
   };
 
   IVecMutex m_Mutex;
@@ -54,6 +82,61 @@ private:
   std::shared_mutex m_SharedUpdateMutex;
   std::unordered_map<glm::ivec3, SparseVoxelOctree *> m_Chunks;
 
+  /**
+   * The chunks frozen once they are generated, the rays are traced against
+   * these instead of the pointer trees.
+   */
+  std::unordered_map<glm::ivec3, LinearOctree> m_Frozen;
+
+  /**
+   * The direction of the ray of every pixel, row by row.
+   */
+  std::vector<glm::vec3> m_Directions;
+
+  std::atomic<bool> m_PacketTracing = true;
+
+private:
+  /**
+   * Starts a walk at the chunk of the origin.
+   */
+  ChunkWalk startWalk(const glm::vec3 &origin,
+                      const glm::vec3 &direction) const;
+
+  /**
+   * Moves the walk into the next chunk the ray crosses.
+   */
+  static void StepWalk(ChunkWalk &walk);
+
+  /**
+   * INSIDE if the chunk of the walk is within s_ChunkRadius of center,
+   * OUTSIDE if it is not but the ray is heading back towards it, LEFT once
+   * the ray can not come back.
+   */
+  static WalkState GetWalkState(const ChunkWalk &walk,
+                                const glm::ivec3 &center);
+
+  /**
+   * Returns the frozen tree of the chunk if it is loaded and has solid
+   * voxels.
+   */
+  const LinearOctree *getTracedChunk(const glm::ivec3 &coord) const;
+
+  /**
+   * Sets m_Directions of the rows from the camera.
+   */
+  void setRayDirections(const glm::ivec2 &dimension,
+                        const std::vector<int> &rows);
+
+  /**
+   * Traces the ray of every pixel of the rows from origin and writes their
+   * colors into the buffer. With packets, each row is traced in tiles of
+   * s_PacketSize pixels, the pixels left over at the end are traced one at a
+   * time.
+   */
+  void trace(const glm::vec3 &origin, const glm::ivec3 &center,
+             const glm::ivec2 &dimension, const std::vector<int> &rows,
+             std::vector<uint32_t> &buffer, bool packets);
+
 public:
   VoxelManager() = default;
   ~VoxelManager();
@@ -70,6 +153,48 @@ public:
 
   void raytrace(const glm::ivec3 &coord);
 
+  /**
+   * Finds the first voxel hit by the ray in any chunk within s_ChunkRadius of
+   * center.
+   *
+   * Walks a 3D DDA over the grid of chunks from the chunk of the origin, in
+   * the order the ray crosses them, and traces the octree of each one.
+   * Chunks that are not loaded or have no solid voxels are stepped over
+   * without tracing. The first chunk with a hit holds the nearest one.
+   *
+   * @param origin     The origin of the ray, in world-space.
+   * @param direction  The direction of the ray, need not be normalized.
+   * @param center     The chunk the radius is around.
+   * @param hit        Set to the hit, distance is along the ray from origin.
+   * @return           True if the ray hit a voxel, false for a zero
+   * direction.
+   */
+  bool rayTrace(const glm::vec3 &origin, const glm::vec3 &direction,
+                const glm::ivec3 &center, RayHit &hit);
+
+  /**
+   * Traces a packet of rays from the same origin, same result as tracing
+   * each lane with the single ray rayTrace().
+   *
+   * Every lane walks the grid of chunks on it's own. The lanes start in the
+   * same chunk and each step moves every lane into it's next chunk, so the
+   * lanes that are in the same chunk are traced together as one packet, see
+   * LinearOctree::rayTrace().
+   *
+   * @return  The lanes that hit a voxel, bit i is lane i.
+   */
+  uint8_t rayTrace(const glm::vec3 &origin,
+                   const glm::vec3 (&directions)[s_PacketSize],
+                   const glm::ivec3 &center, RayHit (&hits)[s_PacketSize]);
+
+  /**
+   * Traces 8×1 pixel tiles as packets when on, the default, otherwise one ray
+   * per pixel.
+   */
+  void setPacketTracing(bool packetTracing);
+
+  bool isPacketTracing() const;
+
   const std::vector<glm::ivec3>
   getChunkPositionsInRadius(const glm::ivec3 &center) const;
 
@@ -47,4 +47,6 @@ void World::setRegistry(Registry *registry) {
   m_Voxels.setRegistry(m_Registry);
 }
 
-void World::setCamera(PerspectiveCamera *camera) { m_Camera = camera; }
\ No newline at end of file
+void World::setCamera(PerspectiveCamera *camera) { m_Camera = camera; }
+
+VoxelManager &World::getVoxels() { return m_Voxels; }
\ No newline at end of file
@@ -44,6 +44,8 @@ public:
   void setRegistry(Registry *registry);
 
   void setCamera(PerspectiveCamera *camera);
+
+  VoxelManager &getVoxels();
 };
 
 }; // namespace RaytracerCPU
\ No newline at end of file
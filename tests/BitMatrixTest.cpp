@@ -0,0 +1,123 @@
+#include "Voxel/BitMatrix.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Test.h"
+
+/**
+ * Every transpose is compared bit for bit to a naive transpose of the same
+ * random matrix, with ENABLE_AVX256 that covers the AVX2 and the scalar path.
+ */
+
+static std::mt19937_64 s_Random(7);
+
+template <typename T> static T RandomWord() {
+  T word = 0;
+  for (size_t i = 0; i < sizeof(T); i += 8)
+    word |= static_cast<T>(s_Random()) << (i * 8);
+  return word;
+}
+
+/**
+ * Random rows, every 4th matrix is sparse and every 8th is empty so the
+ * skipped slices of RowsToAxes are hit too.
+ */
+template <typename T> static void RandomMatrix(T *matrix, int seed) {
+  constexpr unsigned int N = sizeof(T) * 8;
+
+  for (unsigned int r = 0; r < N; r++) {
+    T row = RandomWord<T>();
+
+    if (seed % 8 == 7)
+      row = 0;
+    else if (seed % 4 == 3)
+      row &= RandomWord<T>() & RandomWord<T>() & RandomWord<T>();
+
+    matrix[r] = row;
+  }
+}
+
+template <typename T> static bool GetBit(T word, unsigned int bit) {
+  return (word >> bit) & 1;
+}
+
+template <typename T> static void NaiveTranspose(const T *in, T *out) {
+  constexpr unsigned int N = sizeof(T) * 8;
+
+  for (unsigned int c = 0; c < N; c++) {
+    out[c] = 0;
+    for (unsigned int r = 0; r < N; r++)
+      out[c] |= static_cast<T>(GetBit(in[r], c)) << r;
+  }
+}
+
+template <typename T> static void TestTranspose() {
+  constexpr unsigned int N = sizeof(T) * 8;
+
+  for (int seed = 0; seed < 64; seed++) {
+    alignas(32) T matrix[N];
+    alignas(32) T scalar[N];
+    T original[N];
+    T expected[N];
+
+    RandomMatrix(original, seed);
+    std::memcpy(matrix, original, sizeof(matrix));
+    std::memcpy(scalar, original, sizeof(matrix));
+    NaiveTranspose(original, expected);
+
+    BitMatrix::Transpose(matrix);
+    BitMatrix::TransposeScalar(scalar);
+
+    EXPECT(std::memcmp(matrix, expected, sizeof(matrix)) == 0);
+    EXPECT(std::memcmp(scalar, expected, sizeof(scalar)) == 0);
+
+    // Transposing again gives back the matrix.
+    BitMatrix::Transpose(matrix);
+    EXPECT(std::memcmp(matrix, original, sizeof(matrix)) == 0);
+  }
+}
+
+template <typename T> static void TestRowsToAxes() {
+  constexpr unsigned int N = sizeof(T) * 8;
+
+  for (int seed = 0; seed < 8; seed++) {
+    std::vector<T> rows(N * N);
+    std::vector<T> columns(N * N, 0);
+    std::vector<T> layers(N * N, 0);
+
+    for (unsigned int z = 0; z < N; z++)
+      RandomMatrix(&rows[N * z], seed + static_cast<int>(z));
+
+    BitMatrix::RowsToAxes(rows.data(), columns.data(), layers.data());
+
+    std::vector<T> expectedColumns(N * N, 0);
+    std::vector<T> expectedLayers(N * N, 0);
+
+    for (unsigned int z = 0; z < N; z++)
+      for (unsigned int y = 0; y < N; y++)
+        for (unsigned int x = 0; x < N; x++) {
+          if (!GetBit(rows[y + N * z], x))
+            continue;
+
+          expectedColumns[x + N * z] |= static_cast<T>(1) << y;
+          expectedLayers[y + N * x] |= static_cast<T>(1) << z;
+        }
+
+    EXPECT(columns == expectedColumns);
+    EXPECT(layers == expectedLayers);
+  }
+}
+
+int main() {
+  TestTranspose<uint32_t>();
+  TestTranspose<uint64_t>();
+  TestTranspose<uint128_t>();
+
+  TestRowsToAxes<uint32_t>();
+  TestRowsToAxes<uint64_t>();
+  TestRowsToAxes<uint128_t>();
+
+  return Test::Result();
+}
@@ -0,0 +1,190 @@
+#include "Voxel/BitPyramid.h"
+#include "Voxel/SparseVoxelOctree.h"
+
+#include <random>
+#include <vector>
+
+#include "Test.h"
+
+/**
+ * Checks every level of the pyramid against one reduced bit by bit, and the
+ * trees set from masks through it against the same voxels built and set one
+ * at a time. Built with and without ENABLE_AVX256, see CMakeLists.txt.
+ */
+
+static std::mt19937 s_Random(11);
+
+/**
+ * Palette ids in the layout x + size * (z + size * y), all 1 if solid.
+ * Otherwise every 8³ block is empty, one id or random ids, and the bottom
+ * quarter is solid, so the full bits of the upper levels are on too.
+ */
+static std::vector<VoxelID> RandomVoxels(int size, bool solid) {
+  std::vector<VoxelID> voxels(size * size * size);
+
+  for (int y = 0; y < size; y++)
+    for (int z = 0; z < size; z++)
+      for (int x = 0; x < size; x++) {
+        const unsigned int block =
+            ((x >> 3) * 73856093u) ^ ((y >> 3) * 19349663u) ^
+            ((z >> 3) * 83492791u);
+
+        VoxelID voxel = EMPTY_VOXEL;
+
+        if (solid)
+          voxel = 1;
+        else if (y < size / 4 || block % 3 == 1)
+          voxel = static_cast<VoxelID>(1 + block % 4);
+        else if (block % 3 == 2)
+          voxel = static_cast<VoxelID>(s_Random() % 5);
+
+        voxels[x + size * (z + size * y)] = voxel;
+      }
+
+  return voxels;
+}
+
+static std::vector<uint64_t> Mask(const std::vector<VoxelID> &voxels,
+                                  VoxelID filter) {
+  std::vector<uint64_t> mask((voxels.size() + 63) / 64, 0);
+
+  for (size_t i = 0; i < voxels.size(); i++)
+    if (filter ? voxels[i] == filter : voxels[i] != EMPTY_VOXEL)
+      mask[i / 64] |= 1ull << (i % 64);
+
+  return mask;
+}
+
+static void TestLevels(int size, bool solid) {
+  const std::vector<uint64_t> mask = Mask(RandomVoxels(size, solid), 0);
+
+  BitPyramid pyramid;
+  pyramid.build(mask.data(), size);
+
+  EXPECT(1 << pyramid.getDepth() == size);
+
+  /**
+   * Level 0 is the mask, every level above is the 2×2×2 blocks of the one
+   * below.
+   */
+  std::vector<bool> full(size * size * size);
+  std::vector<bool> any(size * size * size);
+
+  for (size_t i = 0; i < full.size(); i++)
+    full[i] = any[i] = (mask[i / 64] >> (i % 64)) & 1;
+
+  int failures = 0;
+
+  for (int depth = 0, side = size; side >= 1; depth++, side /= 2) {
+    if (depth > 0) {
+      const int below = side * 2;
+
+      std::vector<bool> nextFull(side * side * side);
+      std::vector<bool> nextAny(side * side * side);
+
+      for (int y = 0; y < side; y++)
+        for (int z = 0; z < side; z++)
+          for (int x = 0; x < side; x++) {
+            bool f = true, a = false;
+
+            for (int i = 0; i < 8; i++) {
+              const int bx = 2 * x + ((i >> 2) & 1);
+              const int by = 2 * y + ((i >> 1) & 1);
+              const int bz = 2 * z + (i & 1);
+              const size_t index = bx + below * (bz + below * by);
+
+              f = f && full[index];
+              a = a || any[index];
+            }
+
+            nextFull[x + side * (z + side * y)] = f;
+            nextAny[x + side * (z + side * y)] = a;
+          }
+
+      full.swap(nextFull);
+      any.swap(nextAny);
+    }
+
+    for (int y = 0; y < side; y++)
+      for (int z = 0; z < side; z++)
+        for (int x = 0; x < side; x++) {
+          const size_t index = x + side * (z + side * y);
+
+          if (pyramid.isFull(depth, x, y, z) != full[index] ||
+              pyramid.isAny(depth, x, y, z) != any[index])
+            failures++;
+        }
+  }
+
+  EXPECT(failures == 0);
+}
+
+/**
+ * Returns the number of positions where the trees hold different voxels.
+ */
+static int Compare(SparseVoxelOctree &a, SparseVoxelOctree &b, int size) {
+  int differences = 0;
+
+  for (int y = 0; y < size; y++)
+    for (int z = 0; z < size; z++)
+      for (int x = 0; x < size; x++) {
+        const Node *nodeA = a.get(x, y, z);
+        const Node *nodeB = b.get(x, y, z);
+
+        if ((nodeA ? nodeA->voxel : EMPTY_VOXEL) !=
+            (nodeB ? nodeB->voxel : EMPTY_VOXEL))
+          differences++;
+      }
+
+  return differences;
+}
+
+static void TestTree(int size, bool solid) {
+  const std::vector<VoxelID> voxels = RandomVoxels(size, solid);
+
+  SparseVoxelOctree built(size);
+  built.build(voxels.data());
+
+  SparseVoxelOctree masked(size);
+
+  for (VoxelID voxel = 1; voxel <= 4; voxel++) {
+    std::vector<uint64_t> mask = Mask(voxels, voxel);
+    masked.set(*reinterpret_cast<uint64_t(*)[]>(mask.data()), voxel);
+  }
+
+  SparseVoxelOctree single(size);
+
+  for (int y = 0; y < size; y++)
+    for (int z = 0; z < size; z++)
+      for (int x = 0; x < size; x++)
+        if (const VoxelID voxel = voxels[x + size * (z + size * y)])
+          single.set(x, y, z, voxel);
+
+  EXPECT(Compare(built, single, size) == 0);
+  EXPECT(Compare(masked, single, size) == 0);
+
+  // Every path collapses uniform blocks the same way.
+  EXPECT(built.getNodeCount() == single.getNodeCount());
+  EXPECT(masked.getNodeCount() == single.getNodeCount());
+
+  // A solid tree is a single leaf.
+  if (solid) {
+    EXPECT(built.getRoot()->voxel == 1);
+    EXPECT(masked.getRoot()->voxel == 1);
+    EXPECT(single.getNodeCount() == 1);
+  }
+}
+
+int main() {
+  for (int size : {8, 32, 128}) {
+    TestLevels(size, false);
+    TestLevels(size, true);
+  }
+
+  for (int size : {16, 64}) {
+    TestTree(size, false);
+    TestTree(size, true);
+  }
+
+  return Test::Result();
+}
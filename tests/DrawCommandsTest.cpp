@@ -0,0 +1,145 @@
+#include "World/Raster/DrawCommands.h"
+
+#include "Test.h"
+
+using namespace Raster;
+
+static constexpr int CHUNK_SIZE = 128;
+static constexpr int REGION_SIZE = 32;
+
+/**
+ * An orthographic frustum around the box, built by hand so it's planes are
+ * exactly the faces of the box.
+ */
+static Frustum BoxFrustum(const glm::vec3 &min, const glm::vec3 &max) {
+  glm::mat4 viewProjection(1.0f);
+
+  for (int i = 0; i < 3; i++) {
+    viewProjection[i][i] = 2.0f / (max[i] - min[i]);
+    viewProjection[3][i] = -(max[i] + min[i]) / (max[i] - min[i]);
+  }
+
+  return Frustum(viewProjection);
+}
+
+static bool Equal(const glm::ivec4 &a, const glm::ivec4 &b) {
+  return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+static void TestAdd() {
+  DrawCommands commands;
+
+  EXPECT(commands.empty());
+
+  commands.add({glm::ivec3(0), 0, 0, 0, 10}, glm::ivec3(0));
+  commands.add({glm::ivec3(1, 0, 0), 0, 0, 10, 0}, glm::ivec3(128, 0, 0));
+  commands.add({glm::ivec3(1, 0, 0), 1, 2, 10, 5}, glm::ivec3(128, 0, 0));
+
+  // The empty range is skipped.
+  EXPECT(commands.size() == 2);
+  EXPECT(commands.getOffsets().size() == 2);
+
+  const auto &list = commands.getCommands();
+
+  for (const DrawElementsIndirectCommand &command : list) {
+    EXPECT(command.count == 6);
+    EXPECT(command.firstIndex == 0);
+    EXPECT(command.baseVertex == 0);
+  }
+
+  EXPECT(list[0].primCount == 10);
+  EXPECT(list[0].baseInstance == 0);
+  EXPECT(list[1].primCount == 5);
+  EXPECT(list[1].baseInstance == 10);
+
+  // w is the size of a cell of the level of detail.
+  EXPECT(Equal(commands.getOffsets()[0], glm::ivec4(0, 0, 0, 1)));
+  EXPECT(Equal(commands.getOffsets()[1], glm::ivec4(128, 0, 0, 4)));
+
+  commands.clear();
+
+  EXPECT(commands.empty());
+  EXPECT(commands.getOffsets().empty());
+}
+
+static void TestAddVisible() {
+  /**
+   * Two regions of chunk 0, one of chunk 1 between two empty ones and one of
+   * chunk 2. The first quad of every range follows the last of the previous.
+   */
+  const std::vector<ChunkRange> ranges = {
+      {glm::ivec3(0, 0, 0), 0, 0, 0, 4},  {glm::ivec3(0, 0, 0), 5, 0, 4, 3},
+      {glm::ivec3(1, 0, 0), 0, 0, 7, 0},  {glm::ivec3(1, 0, 0), 1, 0, 7, 2},
+      {glm::ivec3(1, 0, 0), 2, 0, 9, 0},  {glm::ivec3(0, 0, 1), 3, 1, 9, 6},
+  };
+
+  DrawCommands commands;
+
+  commands.addVisible(ranges,
+                      BoxFrustum(glm::vec3(-1000.0f), glm::vec3(1000.0f)),
+                      CHUNK_SIZE, REGION_SIZE);
+
+  // Everything is visible, the empty ranges are skipped.
+  EXPECT(commands.size() == 4);
+
+  const size_t expected[] = {0, 1, 3, 5};
+
+  for (size_t i = 0; i < commands.size() && i < 4; i++) {
+    const ChunkRange &range = ranges[expected[i]];
+    const DrawElementsIndirectCommand &command = commands.getCommands()[i];
+
+    EXPECT(command.baseInstance == static_cast<unsigned int>(range.first));
+    EXPECT(command.primCount == static_cast<unsigned int>(range.count));
+
+    // The offset of a command is the offset of it's range's chunk.
+    const glm::ivec3 origin = range.coord * CHUNK_SIZE;
+    EXPECT(Equal(commands.getOffsets()[i], glm::ivec4(origin, 1 << range.lod)));
+  }
+}
+
+static void TestCulling() {
+  /**
+   * Regions are 32 wide, region r of a chunk starts at 32 * (r % 4) on x. The
+   * frustum covers x 0 to 48 of chunk 0, anything touching it's faces is kept.
+   */
+  const std::vector<ChunkRange> ranges = {
+      {glm::ivec3(0, 0, 0), 0, 0, 0, 1},  // x 0 to 32, kept
+      {glm::ivec3(0, 0, 0), 1, 0, 1, 1},  // x 32 to 64, kept
+      {glm::ivec3(0, 0, 0), 2, 0, 2, 1},  // x 64 to 96, culled
+      {glm::ivec3(2, 0, 0), 0, 0, 3, 1},  // chunk culled
+      {glm::ivec3(0, 0, 1), 0, 1, 4, 1},  // z 128 to 192, chunk kept
+      {glm::ivec3(0, 0, 1), 1, 1, 5, 1},  // lod 1, x 64 to 128, culled
+  };
+
+  DrawCommands commands;
+
+  commands.addVisible(ranges,
+                      BoxFrustum(glm::vec3(0.0f), glm::vec3(48.0f, 128, 256)),
+                      CHUNK_SIZE, REGION_SIZE);
+
+  EXPECT(commands.size() == 3);
+
+  if (commands.size() != 3)
+    return;
+
+  EXPECT(commands.getCommands()[0].baseInstance == 0);
+  EXPECT(commands.getCommands()[1].baseInstance == 1);
+  EXPECT(commands.getCommands()[2].baseInstance == 4);
+
+  EXPECT(Equal(commands.getOffsets()[2], glm::ivec4(0, 0, 128, 2)));
+
+  // Culling again replaces nothing, the commands are added to.
+  commands.addVisible(ranges,
+                      BoxFrustum(glm::vec3(1000.0f), glm::vec3(2000.0f)),
+                      CHUNK_SIZE, REGION_SIZE);
+
+  EXPECT(commands.size() == 3);
+}
+
+int main() {
+  TestAdd();
+  TestAddVisible();
+  TestCulling();
+
+  return Test::Result();
+}
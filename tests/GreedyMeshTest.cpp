@@ -0,0 +1,208 @@
+#include "Voxel/GreedyMesh.h"
+
+#include <memory>
+#include <set>
+#include <tuple>
+
+#include "Test.h"
+
+/**
+ * The greedy meshers are compared by the surface they cover, every quad is
+ * split back into the unit faces it's made of. Quads merge differently at
+ * different widths but must cover the same faces.
+ */
+
+static constexpr int SIZE = 128;
+
+/**
+ * x, y, z, face, palette id.
+ */
+using UnitFace = std::tuple<int, int, int, int, int>;
+
+/**
+ * Terrain from a sine height map with palette ids in layers, a few floating
+ * blocks and holes so there are faces in every direction.
+ */
+static std::vector<VoxelID> Terrain() {
+  std::vector<VoxelID> voxels(SIZE * SIZE * SIZE, EMPTY_VOXEL);
+
+  for (int y = 0; y < SIZE; y++)
+    for (int z = 0; z < SIZE; z++)
+      for (int x = 0; x < SIZE; x++) {
+        const int height = static_cast<int>(
+            60 + 30 * std::sin(x * 0.09f) * std::cos(z * 0.05f));
+
+        VoxelID voxel = EMPTY_VOXEL;
+
+        if (y < height)
+          voxel = static_cast<VoxelID>(1 + std::min(y / 24, 3));
+
+        // Floating cubes and caves.
+        if (((x / 7) + (y / 5) + (z / 9)) % 11 == 0)
+          voxel = voxel ? EMPTY_VOXEL : 2;
+
+        voxels[x + SIZE * (z + SIZE * y)] = voxel;
+      }
+
+  return voxels;
+}
+
+/**
+ * Adds the unit faces of the quads, returns false if a face is covered twice.
+ */
+static bool AddFaces(const std::vector<PackedQuad> &quads,
+                     std::set<UnitFace> &faces) {
+  bool unique = true;
+
+  for (const PackedQuad &quad : quads) {
+    const int x = quad.position & 0x7F;
+    const int y = (quad.position >> 7) & 0x7F;
+    const int z = (quad.position >> 14) & 0x7F;
+    const int face = (quad.position >> 21) & 0x7;
+    const int width = (quad.extent & 0x7F) + 1;
+    const int height = ((quad.extent >> 7) & 0x7F) + 1;
+    const int voxel = quad.extent >> 16;
+
+    for (int h = 0; h < height; h++)
+      for (int w = 0; w < width; w++) {
+        glm::ivec3 p(x, y, z);
+
+        switch (static_cast<FaceType>(face)) {
+        case FaceType::TOP:
+        case FaceType::BOTTOM:
+          p += glm::ivec3(w, 0, h);
+          break;
+        case FaceType::LEFT:
+        case FaceType::RIGHT:
+          p += glm::ivec3(0, w, h);
+          break;
+        case FaceType::FRONT:
+        case FaceType::BACK:
+          p += glm::ivec3(w, h, 0);
+          break;
+        }
+
+        unique &= faces.emplace(p.x, p.y, p.z, face, voxel).second;
+      }
+  }
+
+  return unique;
+}
+
+/**
+ * Every face of a solid voxel next to an empty one or the edge of the size³
+ * grid.
+ */
+static std::set<UnitFace> ExposedFaces(const std::vector<VoxelID> &voxels,
+                                       int size) {
+  static constexpr int directions[6][3] = {{0, 1, 0},  {0, -1, 0}, {-1, 0, 0},
+                                           {1, 0, 0},  {0, 0, -1}, {0, 0, 1}};
+
+  auto at = [&](int x, int y, int z) -> VoxelID {
+    if (x < 0 || y < 0 || z < 0 || x >= size || y >= size || z >= size)
+      return EMPTY_VOXEL;
+    return voxels[x + size * (z + size * y)];
+  };
+
+  std::set<UnitFace> faces;
+
+  for (int y = 0; y < size; y++)
+    for (int z = 0; z < size; z++)
+      for (int x = 0; x < size; x++) {
+        const VoxelID voxel = at(x, y, z);
+
+        if (!voxel)
+          continue;
+
+        for (int face = 0; face < 6; face++) {
+          const int *d = directions[face];
+          if (!at(x + d[0], y + d[1], z + d[2]))
+            faces.emplace(x, y, z, face, voxel);
+        }
+      }
+
+  return faces;
+}
+
+static void TestWidths() {
+  const std::vector<VoxelID> voxels = Terrain();
+
+  SparseVoxelOctree tree(SIZE);
+  tree.build(voxels.data());
+
+  const Palette palette = {Voxel(1, 1, 1, 255), Voxel(2, 2, 2, 255),
+                           Voxel(3, 3, 3, 255), Voxel(4, 4, 4, 255)};
+
+  std::vector<PackedQuad> whole;
+  auto context128 = std::make_unique<GreedyMesh128::Context>();
+  GreedyMesh128::Octree(*context128, &tree, palette, whole, 0, 0, 0);
+
+  std::vector<PackedQuad> regions;
+  auto context64 = std::make_unique<GreedyMesh64::Context>();
+
+  for (int region = 0; region < 8; region++)
+    GreedyMesh64::Octree(*context64, &tree, palette, regions,
+                         (region & 1) * 64, ((region >> 1) & 1) * 64,
+                         ((region >> 2) & 1) * 64);
+
+  std::set<UnitFace> wholeFaces, regionFaces;
+
+  EXPECT(AddFaces(whole, wholeFaces));
+  EXPECT(AddFaces(regions, regionFaces));
+
+  const std::set<UnitFace> expected = ExposedFaces(voxels, SIZE);
+
+  EXPECT(wholeFaces == expected);
+  EXPECT(regionFaces == expected);
+
+  // One call merges across the region borders.
+  EXPECT(whole.size() <= regions.size());
+}
+
+/**
+ * A coarse mesh covers the faces of the averaged cells, in cells. The cells
+ * come from SparseVoxelOctree::forEachCell(), see SparseVoxelOctreeTest.
+ */
+static void TestLevelOfDetail() {
+  const std::vector<VoxelID> voxels = Terrain();
+
+  SparseVoxelOctree tree(SIZE);
+  tree.build(voxels.data());
+
+  const Palette palette = {Voxel(1, 1, 1, 255), Voxel(2, 2, 2, 255),
+                           Voxel(3, 3, 3, 255), Voxel(4, 4, 4, 255)};
+
+  auto context = std::make_unique<GreedyMesh64::Context>();
+
+  for (int lod = 1; lod <= 3; lod++) {
+    const int cellSize = 1 << lod;
+    const int cells = SIZE / cellSize;
+
+    std::vector<VoxelID> averages(cells * cells * cells, EMPTY_VOXEL);
+
+    tree.forEachCell(0, 0, 0, SIZE, cellSize,
+                     [&](int x, int y, int z, int length, VoxelID voxel) {
+                       for (int dy = 0; dy < length; dy++)
+                         for (int dz = 0; dz < length; dz++)
+                           for (int dx = 0; dx < length; dx++)
+                             averages[(x + dx) +
+                                      cells * ((z + dz) + cells * (y + dy))] =
+                                 voxel;
+                     });
+
+    std::vector<PackedQuad> quads;
+    GreedyMesh64::Octree(*context, &tree, palette, quads, 0, 0, 0, lod);
+
+    std::set<UnitFace> faces;
+
+    EXPECT(AddFaces(quads, faces));
+    EXPECT(faces == ExposedFaces(averages, cells));
+  }
+}
+
+int main() {
+  TestWidths();
+  TestLevelOfDetail();
+
+  return Test::Result();
+}
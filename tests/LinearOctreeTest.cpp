@@ -0,0 +1,171 @@
+#include "Voxel/LinearOctree.h"
+#include "Voxel/SparseVoxelOctree.h"
+
+#include <random>
+
+#include "Test.h"
+
+/**
+ * A frozen tree must answer every lookup and every ray the same as the
+ * pointer tree it was frozen from.
+ */
+
+static constexpr int SIZE = 64;
+static constexpr int PACKET_SIZE = LinearOctree::PACKET_SIZE;
+
+/**
+ * Hills with floating blocks, then random voxels set and removed so the tree
+ * has single voxel leaves and subtrees left without solid voxels.
+ */
+static void Terrain(SparseVoxelOctree &tree) {
+  std::vector<VoxelID> voxels(SIZE * SIZE * SIZE, EMPTY_VOXEL);
+
+  for (int y = 0; y < SIZE; y++)
+    for (int z = 0; z < SIZE; z++)
+      for (int x = 0; x < SIZE; x++) {
+        const int height = static_cast<int>(
+            20 + 12 * std::sin(x * 0.2f) * std::cos(z * 0.15f));
+
+        VoxelID voxel = y < height ? 1 + y / 16 : EMPTY_VOXEL;
+
+        if (y > 40 && ((x / 4) + (y / 4) + (z / 4)) % 7 == 0)
+          voxel = 4;
+
+        voxels[x + SIZE * (z + SIZE * y)] = voxel;
+      }
+
+  tree.build(voxels.data());
+
+  std::mt19937 random(5);
+  std::uniform_int_distribution<int> position(0, SIZE - 1);
+  std::uniform_int_distribution<int> voxel(0, 4);
+
+  for (int i = 0; i < 3000; i++)
+    tree.set(position(random), position(random), position(random),
+             static_cast<VoxelID>(voxel(random)));
+}
+
+static VoxelID Get(SparseVoxelOctree &tree, int x, int y, int z,
+                   VoxelID filter) {
+  const Node *node = tree.get(x, y, z, filter);
+  return node ? node->voxel : EMPTY_VOXEL;
+}
+
+static bool Equal(const RayHit &a, const RayHit &b) {
+  return a.voxel == b.voxel && a.distance == b.distance &&
+         a.normal.x == b.normal.x && a.normal.y == b.normal.y &&
+         a.normal.z == b.normal.z;
+}
+
+/**
+ * Every position, and one past each side, with and without a filter.
+ */
+static void TestGet() {
+  SparseVoxelOctree tree(SIZE);
+  Terrain(tree);
+
+  const LinearOctree frozen = tree.freeze();
+
+  EXPECT(frozen.getSize() == SIZE);
+  EXPECT(frozen.getNodeCount() > 1);
+  EXPECT(frozen.getNodeCount() <= tree.getNodeCount());
+
+  bool match = true;
+
+  for (VoxelID filter = EMPTY_VOXEL; filter <= 4; filter++)
+    for (int y = -1; y <= SIZE; y++)
+      for (int z = -1; z <= SIZE; z++)
+        for (int x = -1; x <= SIZE; x++)
+          match &= frozen.get(x, y, z, filter) == Get(tree, x, y, z, filter);
+
+  EXPECT(match);
+}
+
+/**
+ * Random rays from inside and around the tree, one at a time and in packets
+ * of coherent and diverging lanes.
+ */
+static void TestRayTrace() {
+  SparseVoxelOctree tree(SIZE);
+  Terrain(tree);
+
+  const LinearOctree frozen = tree.freeze();
+
+  std::mt19937 random(11);
+  std::uniform_real_distribution<float> position(-8.0f, SIZE + 8.0f);
+  std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+  bool match = true;
+
+  for (int i = 0; i < 2000; i++) {
+    const glm::vec3 origin(position(random), position(random),
+                           position(random));
+
+    glm::vec3 directions[PACKET_SIZE];
+
+    for (glm::vec3 &d : directions)
+      d = glm::vec3(direction(random), direction(random), direction(random));
+
+    // Every other packet heads into one octant.
+    if (i % 2)
+      for (glm::vec3 &d : directions)
+        d = glm::abs(d) * glm::sign(directions[0]);
+
+    for (const glm::vec3 &d : directions) {
+      RayHit expected, hit;
+
+      match &= tree.rayTrace(origin, d, expected) ==
+               frozen.rayTrace(origin, d, hit);
+      match &= Equal(hit, expected);
+    }
+
+    const uint8_t lanes = i % 3 ? 0xFF : static_cast<uint8_t>(random());
+
+    RayHit expected[PACKET_SIZE], hits[PACKET_SIZE];
+
+    match &= tree.rayTrace(origin, directions, lanes, expected) ==
+             frozen.rayTrace(origin, directions, lanes, hits);
+
+    for (int lane = 0; lane < PACKET_SIZE; lane++)
+      if (lanes & (1 << lane))
+        match &= Equal(hits[lane], expected[lane]);
+  }
+
+  EXPECT(match);
+}
+
+/**
+ * An empty tree, and a tree that is one solid leaf, freeze to a single node.
+ */
+static void TestEmptyAndSolid() {
+  SparseVoxelOctree tree(SIZE);
+
+  LinearOctree frozen = tree.freeze();
+  RayHit hit;
+
+  EXPECT(frozen.isEmpty());
+  EXPECT(frozen.getNodeCount() == 1);
+  EXPECT(frozen.get(0, 0, 0) == EMPTY_VOXEL);
+  EXPECT(!frozen.rayTrace(glm::vec3(-1.0f), glm::vec3(1.0f), hit));
+
+  tree.set(0, 0, 0, 3, SIZE);
+  frozen = tree.freeze();
+
+  EXPECT(!frozen.isEmpty());
+  EXPECT(frozen.getNodeCount() == 1);
+  EXPECT(frozen.get(SIZE - 1, 0, 7) == 3);
+  EXPECT(frozen.get(0, 0, 0, 2) == EMPTY_VOXEL);
+  EXPECT(frozen.rayTrace(glm::vec3(-1.0f), glm::vec3(1.0f), hit));
+  EXPECT(hit.voxel == 3 && hit.distance == 1.0f);
+
+  EXPECT(LinearOctree().isEmpty());
+  EXPECT(LinearOctree().get(0, 0, 0) == EMPTY_VOXEL);
+}
+
+int main() {
+  TestGet();
+  TestRayTrace();
+  TestEmptyAndSolid();
+
+  return Test::Result();
+}
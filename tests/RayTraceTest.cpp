@@ -0,0 +1,167 @@
+#include "Voxel/SparseVoxelOctree.h"
+
+#include <random>
+
+#include "Test.h"
+
+/**
+ * The packet rayTrace() must give every lane the same hit as tracing it on
+ * it's own, whether the lanes share one walk of the tree or diverge and fall
+ * back to one lane at a time.
+ */
+
+static constexpr int SIZE = 64;
+static constexpr int PACKET_SIZE = SparseVoxelOctree::PACKET_SIZE;
+
+/**
+ * Hills with floating blocks, so rays hit near, far, on edges and not at all.
+ */
+static void Terrain(SparseVoxelOctree &tree) {
+  std::vector<VoxelID> voxels(SIZE * SIZE * SIZE, EMPTY_VOXEL);
+
+  for (int y = 0; y < SIZE; y++)
+    for (int z = 0; z < SIZE; z++)
+      for (int x = 0; x < SIZE; x++) {
+        const int height = static_cast<int>(
+            20 + 12 * std::sin(x * 0.2f) * std::cos(z * 0.15f));
+
+        VoxelID voxel = y < height ? 1 + y / 16 : EMPTY_VOXEL;
+
+        if (y > 40 && ((x / 4) + (y / 4) + (z / 4)) % 7 == 0)
+          voxel = 4;
+
+        voxels[x + SIZE * (z + SIZE * y)] = voxel;
+      }
+
+  tree.build(voxels.data());
+}
+
+static bool Equal(const RayHit &a, const RayHit &b) {
+  return a.voxel == b.voxel && a.distance == b.distance &&
+         a.normal.x == b.normal.x && a.normal.y == b.normal.y &&
+         a.normal.z == b.normal.z;
+}
+
+/**
+ * Traces the lanes as a packet and one at a time, returns true if every
+ * traced lane has the same hit both ways.
+ */
+static bool Match(SparseVoxelOctree &tree, const glm::vec3 &origin,
+                  const glm::vec3 (&directions)[PACKET_SIZE],
+                  uint8_t lanes = 0xFF) {
+  RayHit hits[PACKET_SIZE];
+  const uint8_t hit = tree.rayTrace(origin, directions, lanes, hits);
+
+  if (hit & ~lanes)
+    return false;
+
+  for (int lane = 0; lane < PACKET_SIZE; lane++) {
+    if (!(lanes & (1 << lane)))
+      continue;
+
+    RayHit expected;
+    const bool scalar = tree.rayTrace(origin, directions[lane], expected);
+
+    if (scalar != static_cast<bool>(hit & (1 << lane)))
+      return false;
+
+    if (scalar && !Equal(hits[lane], expected))
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Rows of a pinhole camera, every packet heads into the same octant like
+ * the 8×1 tiles of the raytracer.
+ */
+static void TestCoherent() {
+  SparseVoxelOctree tree(SIZE);
+  Terrain(tree);
+
+  const glm::vec3 origin(32.5f, 55.0f, 0.5f);
+  bool match = true;
+
+  for (int y = 0; y < 32; y++)
+    for (int x = 0; x < 64; x += PACKET_SIZE) {
+      glm::vec3 directions[PACKET_SIZE];
+
+      for (int lane = 0; lane < PACKET_SIZE; lane++)
+        directions[lane] = glm::vec3((x + lane - 31.5f) / 32.0f,
+                                     (y - 24.0f) / 32.0f, 1.0f);
+
+      match &= Match(tree, origin, directions);
+    }
+
+  EXPECT(match);
+}
+
+/**
+ * Lanes pointing every way, from inside empty and solid voxels.
+ */
+static void TestDiverging() {
+  SparseVoxelOctree tree(SIZE);
+  Terrain(tree);
+
+  std::mt19937 random(11);
+  std::uniform_real_distribution<float> position(0.0f, SIZE);
+  std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+  bool match = true;
+
+  for (int i = 0; i < 2000; i++) {
+    const glm::vec3 origin(position(random), position(random),
+                           position(random));
+
+    glm::vec3 directions[PACKET_SIZE];
+    for (glm::vec3 &d : directions)
+      d = glm::vec3(direction(random), direction(random), direction(random));
+
+    match &= Match(tree, origin, directions);
+    match &= Match(tree, origin, directions, static_cast<uint8_t>(random()));
+  }
+
+  EXPECT(match);
+}
+
+/**
+ * Lanes along the axes and lanes without a direction, next to lanes that
+ * share one walk of the tree.
+ */
+static void TestZeroDirection() {
+  SparseVoxelOctree tree(SIZE);
+  Terrain(tree);
+
+  const glm::vec3 directions[PACKET_SIZE] = {
+      {0.0f, 0.0f, 0.0f},  {0.0f, -1.0f, 0.0f}, {0.3f, -1.0f, 0.2f},
+      {0.0f, 0.0f, 0.0f},  {1.0f, 0.0f, 0.0f},  {0.2f, -0.5f, 0.7f},
+      {0.0f, -1.0f, 1.0f}, {0.0f, 0.0f, 0.0f},
+  };
+
+  const glm::vec3 positive[PACKET_SIZE] = {
+      {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.3f, 0.1f, 0.2f},
+      {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.2f, 0.5f, 0.7f},
+      {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f},
+  };
+
+  // Above the hills, and inside the ground.
+  for (const glm::vec3 &origin :
+       {glm::vec3(10.5f, 50.5f, 10.5f), glm::vec3(30.5f, 2.5f, 30.5f)}) {
+    EXPECT(Match(tree, origin, directions));
+    EXPECT(Match(tree, origin, positive));
+  }
+
+  const glm::vec3 zero[PACKET_SIZE] = {};
+
+  EXPECT(Match(tree, glm::vec3(10.5f, 50.5f, 10.5f), zero));
+  EXPECT(Match(tree, glm::vec3(30.5f, 2.5f, 30.5f), zero));
+}
+
+int main() {
+  TestCoherent();
+  TestDiverging();
+  TestZeroDirection();
+
+  return Test::Result();
+}
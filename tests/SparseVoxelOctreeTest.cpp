@@ -0,0 +1,276 @@
+#include "Voxel/SparseVoxelOctree.h"
+
+#include <algorithm>
+#include <random>
+
+#include "Test.h"
+
+/**
+ * Edits mark the regions that have to be meshed again, see
+ * SparseVoxelOctree::markDirty(). Trees are 128 wide so they have 2 regions
+ * along each axis.
+ */
+
+static constexpr int SIZE = 128;
+
+static bool Equal(const glm::ivec3 &a, const glm::ivec3 &b) {
+  return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+/**
+ * Returns true if the dirty regions of the tree are exactly the expected
+ * ones, in any order. Clears them.
+ */
+static bool TakeDirty(SparseVoxelOctree &tree,
+                      std::vector<glm::ivec3> expected) {
+  const std::vector<glm::ivec3> dirty = tree.takeDirtyRegions();
+
+  if (dirty.size() != expected.size())
+    return false;
+
+  for (const glm::ivec3 &region : dirty) {
+    auto it = std::find_if(
+        expected.begin(), expected.end(),
+        [&](const glm::ivec3 &other) { return Equal(other, region); });
+    if (it == expected.end())
+      return false;
+    expected.erase(it);
+  }
+
+  return true;
+}
+
+static void TestTake() {
+  SparseVoxelOctree tree(SIZE);
+
+  // A new tree has never been meshed.
+  EXPECT(tree.takeDirtyRegions().size() == 8);
+  EXPECT(tree.takeDirtyRegions().empty());
+
+  tree.clear();
+  tree.clearDirtyRegions();
+  EXPECT(tree.takeDirtyRegions().empty());
+}
+
+static void TestRegionBorder() {
+  SparseVoxelOctree tree(SIZE);
+  tree.clearDirtyRegions();
+
+  tree.set(10, 10, 10, 1);
+  EXPECT(TakeDirty(tree, {{0, 0, 0}}));
+
+  // On the +x face of region 0, the faces of region 1 may change too.
+  tree.set(63, 10, 10, 1);
+  EXPECT(TakeDirty(tree, {{0, 0, 0}, {64, 0, 0}}));
+
+  // A corner of four regions only touches the ones across it's faces.
+  tree.set(64, 63, 64, EMPTY_VOXEL);
+  EXPECT(TakeDirty(tree, {{64, 0, 64}, {64, 64, 64}, {0, 0, 64}, {64, 0, 0}}));
+
+  // Without neighbours the edge of the tree marks nothing outside it.
+  tree.set(0, 0, 0, 1);
+  EXPECT(TakeDirty(tree, {{0, 0, 0}}));
+}
+
+static void TestChunkBorder() {
+  SparseVoxelOctree center(SIZE);
+  SparseVoxelOctree right(SIZE);
+  SparseVoxelOctree front(SIZE);
+  SparseVoxelOctree far(SIZE);
+
+  const std::unordered_map<glm::ivec3, SparseVoxelOctree *> chunks = {
+      {{0, 0, 0}, &center},
+      {{1, 0, 0}, &right},
+      {{0, 0, 1}, &front},
+      {{5, 0, 0}, &far},
+  };
+
+  for (auto &[coord, tree] : chunks) {
+    tree->setNeighbours(coord, chunks);
+    tree->clearDirtyRegions();
+  }
+
+  center.set(127, 70, 127, 1);
+
+  EXPECT(TakeDirty(center, {{64, 64, 64}}));
+  EXPECT(TakeDirty(right, {{0, 64, 64}}));
+  EXPECT(TakeDirty(front, {{64, 64, 0}}));
+  EXPECT(TakeDirty(far, {}));
+
+  // An edit inside the chunk leaves the neighbours alone.
+  center.set(100, 70, 100, 1);
+
+  EXPECT(TakeDirty(center, {{64, 64, 64}}));
+  EXPECT(TakeDirty(right, {}));
+  EXPECT(TakeDirty(front, {}));
+
+  // The -x neighbour is missing, nothing is marked for it.
+  center.set(0, 0, 0, 1);
+
+  EXPECT(TakeDirty(center, {{0, 0, 0}}));
+  EXPECT(TakeDirty(right, {}));
+}
+
+static void TestPrune() {
+  SparseVoxelOctree tree(SIZE);
+
+  const size_t empty = tree.getNodeCount();
+
+  // Clearing a voxel gives every node made for it back.
+  tree.set(5, 6, 7, 1);
+  EXPECT(tree.getNodeCount() > empty);
+  tree.set(5, 6, 7, EMPTY_VOXEL);
+  EXPECT(tree.getNodeCount() == empty);
+  EXPECT(tree.getRoot()->isEmpty());
+
+  // Clearing a voxel that was never set leaves nothing behind.
+  tree.set(100, 1, 90, EMPTY_VOXEL);
+  EXPECT(tree.getNodeCount() == empty);
+
+  std::vector<glm::ivec3> positions;
+
+  for (int i = 0; i < 500; i++)
+    positions.emplace_back((i * 37) % SIZE, (i * 11) % SIZE, (i * 73) % SIZE);
+
+  for (const glm::ivec3 &p : positions)
+    tree.set(p.x, p.y, p.z, static_cast<VoxelID>(1 + p.x % 3));
+
+  for (const glm::ivec3 &p : positions)
+    tree.set(p.x, p.y, p.z, EMPTY_VOXEL);
+
+  EXPECT(tree.getNodeCount() == empty);
+  EXPECT(tree.getRoot()->isEmpty());
+
+  // A hole punched into a solid tree and filled again merges back.
+  std::vector<VoxelID> voxels(SIZE * SIZE * SIZE, 2);
+  tree.build(voxels.data());
+
+  const size_t solid = tree.getNodeCount();
+
+  tree.set(64, 64, 64, EMPTY_VOXEL);
+  EXPECT(tree.getNodeCount() > solid);
+  EXPECT(tree.get(64, 64, 64) == nullptr);
+  EXPECT(tree.get(64, 64, 65) != nullptr);
+
+  tree.set(64, 64, 64, 2);
+  EXPECT(tree.getNodeCount() == solid);
+  EXPECT(tree.getRoot()->isSolid());
+}
+
+/**
+ * The average of a cell as Node::getAverageVoxel() defines it, walked down to
+ * single voxels: every non-empty octant votes once with it's own average.
+ */
+static VoxelID Average(const std::vector<VoxelID> &voxels, int size, int x,
+                       int y, int z, int cellSize) {
+  if (cellSize == 1)
+    return voxels[x + size * (z + size * y)];
+
+  const int half = cellSize / 2;
+
+  VoxelID ids[8];
+  int counts[8];
+  int found = 0;
+
+  for (int i = 0; i < 8; i++) {
+    const VoxelID id =
+        Average(voxels, size, x + ((i >> 2) & 1) * half,
+                y + ((i >> 1) & 1) * half, z + (i & 1) * half, half);
+
+    if (!id)
+      continue;
+
+    int j = 0;
+    while (j < found && ids[j] != id)
+      j++;
+
+    if (j == found) {
+      ids[found] = id;
+      counts[found++] = 0;
+    }
+
+    counts[j]++;
+  }
+
+  VoxelID average = EMPTY_VOXEL;
+  int best = 0;
+
+  for (int i = 0; i < found; i++)
+    if (counts[i] > best) {
+      average = ids[i];
+      best = counts[i];
+    }
+
+  return average;
+}
+
+static void TestCells() {
+  static constexpr int size = 32;
+
+  std::mt19937 random(7);
+  std::vector<VoxelID> voxels(size * size * size, EMPTY_VOXEL);
+
+  /**
+   * 4³ blocks that are empty, one id or mixed, so the cells are made of
+   * leaves larger and smaller than them.
+   */
+  for (int y = 0; y < size; y++)
+    for (int z = 0; z < size; z++)
+      for (int x = 0; x < size; x++) {
+        std::mt19937 block((x / 4) + 8 * ((y / 4) + 8 * (z / 4)));
+        const int kind = block() % 3;
+
+        VoxelID voxel = EMPTY_VOXEL;
+        if (kind == 1)
+          voxel = 1 + block() % 3;
+        else if (kind == 2)
+          voxel = random() % 4;
+
+        voxels[x + size * (z + size * y)] = voxel;
+      }
+
+  SparseVoxelOctree tree(size);
+  tree.build(voxels.data());
+
+  for (int cellSize : {1, 2, 4, 8}) {
+    const int cells = size / cellSize;
+
+    std::vector<VoxelID> averages(cells * cells * cells, EMPTY_VOXEL);
+    bool unique = true;
+
+    auto fill = [&](int x, int y, int z, int length, VoxelID voxel) {
+      for (int dy = 0; dy < length; dy++)
+        for (int dz = 0; dz < length; dz++)
+          for (int dx = 0; dx < length; dx++) {
+            const int i = (x + dx) + cells * ((z + dz) + cells * (y + dy));
+            unique &= averages[i] == EMPTY_VOXEL;
+            averages[i] = voxel;
+          }
+    };
+
+    tree.forEachCell(0, 0, 0, size, cellSize, fill);
+
+    EXPECT(unique);
+
+    bool equal = true;
+
+    for (int y = 0; y < cells; y++)
+      for (int z = 0; z < cells; z++)
+        for (int x = 0; x < cells; x++)
+          equal &= averages[x + cells * (z + cells * y)] ==
+                   Average(voxels, size, x * cellSize, y * cellSize,
+                           z * cellSize, cellSize);
+
+    EXPECT(equal);
+  }
+}
+
+int main() {
+  TestTake();
+  TestPrune();
+  TestRegionBorder();
+  TestChunkBorder();
+  TestCells();
+
+  return Test::Result();
+}
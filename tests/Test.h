@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdio>
+
+/**
+ * The checks of the tests, a failed check is printed and counted, the test
+ * keeps going so every failure of a run is reported.
+ *
+ * Example usage:
+ *
+ *   int main() {
+ *     EXPECT(1 + 1 == 2);
+ *     return Test::Result();
+ *   }
+ */
+namespace Test {
+
+inline int s_Failures = 0;
+
+/**
+ * Returns the exit code of the test, 0 if every check passed.
+ */
+inline int Result() {
+  if (s_Failures)
+    std::printf("%d check(s) failed\n", s_Failures);
+
+  return s_Failures ? 1 : 0;
+}
+
+} // namespace Test
+
+#define EXPECT(condition)                                                      \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      Test::s_Failures++;                                                      \
+      std::printf("%s:%d: EXPECT(%s) failed\n", __FILE__, __LINE__,            \
+                  #condition);                                                 \
+    }                                                                          \
+  } while (0)
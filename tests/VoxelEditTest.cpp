@@ -0,0 +1,164 @@
+#include "Voxel/GreedyMesh.h"
+#include "World/Raster/Components.h"
+
+#include <memory>
+
+#include "Test.h"
+
+/**
+ * An edit only meshes the regions the trees marked dirty again and replaces
+ * their quads in the voxel buffer, the way Raster::VoxelManager::setVoxel()
+ * does. The quads must then be the same as meshing every region again, and
+ * only the chunks that changed are published for upload.
+ */
+
+static constexpr int SIZE = 128;
+static constexpr int REGION = GreedyMesh64::CHUNK_SIZE;
+static constexpr int REGIONS = SIZE / REGION;
+
+static_assert(REGION == SparseVoxelOctree::DIRTY_REGION_SIZE,
+              "Edits are tracked in the regions that are meshed");
+
+struct Chunks {
+  std::vector<std::unique_ptr<SparseVoxelOctree>> trees;
+  std::unordered_map<glm::ivec3, SparseVoxelOctree *> coords;
+
+  Palette palette = {Voxel(1, 1, 1, 255), Voxel(2, 2, 2, 255)};
+
+  std::unique_ptr<GreedyMesh64::Context> context =
+      std::make_unique<GreedyMesh64::Context>();
+
+  Raster::CVoxelBuffer buffer;
+
+  std::vector<PackedQuad> mesh(const glm::ivec3 &coord, int region) {
+    SparseVoxelOctree *tree = coords.at(coord);
+    tree->setNeighbours(coord, coords);
+
+    std::vector<PackedQuad> quads;
+    GreedyMesh64::Octree(*context, tree, palette, quads,
+                         (region % REGIONS) * REGION,
+                         ((region / REGIONS) % REGIONS) * REGION,
+                         (region / (REGIONS * REGIONS)) * REGION);
+    return quads;
+  }
+
+  /**
+   * Meshes the dirty regions of every chunk into the buffer, returns how
+   * many were meshed.
+   */
+  int meshDirty() {
+    int meshed = 0;
+
+    for (const auto &[coord, tree] : coords)
+      for (const glm::ivec3 &origin : tree->takeDirtyRegions()) {
+        const int region =
+            (origin.x / REGION) +
+            REGIONS * ((origin.y / REGION) + REGIONS * (origin.z / REGION));
+
+        buffer.setQuads(coord, region, mesh(coord, region));
+        meshed++;
+      }
+
+    buffer.flush();
+    return meshed;
+  }
+};
+
+static bool Equal(const std::vector<PackedQuad> &a,
+                  const std::vector<PackedQuad> &b) {
+  if (a.size() != b.size())
+    return false;
+
+  for (size_t i = 0; i < a.size(); i++)
+    if (a[i].position != b[i].position || a[i].extent != b[i].extent)
+      return false;
+
+  return true;
+}
+
+/**
+ * Returns true if the changes are exactly the expected chunks, and the quads
+ * of every region of them are the same as meshing it again.
+ */
+static bool Published(Chunks &chunks, std::vector<glm::ivec3> expected) {
+  std::unordered_map<glm::ivec3, Raster::ChunkMesh> changes;
+  chunks.buffer.takeChanges(changes);
+
+  if (changes.size() != expected.size())
+    return false;
+
+  for (const glm::ivec3 &coord : expected) {
+    auto it = changes.find(coord);
+    if (it == changes.end())
+      return false;
+
+    const Raster::ChunkMesh &mesh = it->second;
+    size_t first = 0;
+
+    for (int region = 0; region < REGIONS * REGIONS * REGIONS; region++) {
+      const size_t count = mesh.regions[region];
+      const std::vector<PackedQuad> quads(
+          mesh.quads.begin() + first, mesh.quads.begin() + first + count);
+
+      if (!Equal(quads, chunks.mesh(coord, region)))
+        return false;
+
+      first += count;
+    }
+  }
+
+  return true;
+}
+
+static void TestEdit() {
+  Chunks chunks;
+
+  std::vector<VoxelID> voxels(SIZE * SIZE * SIZE, EMPTY_VOXEL);
+  for (int y = 0; y < 70; y++)
+    for (int i = 0; i < SIZE * SIZE; i++)
+      voxels[i + SIZE * SIZE * y] = 1;
+
+  for (const glm::ivec3 &coord : {glm::ivec3(-1, 0, 0), glm::ivec3(0, 0, 0),
+                                  glm::ivec3(1, 0, 0)}) {
+    chunks.trees.push_back(std::make_unique<SparseVoxelOctree>(SIZE));
+    chunks.trees.back()->build(voxels.data());
+    chunks.coords[coord] = chunks.trees.back().get();
+  }
+
+  // Every region of every chunk is meshed once.
+  for (const auto &[coord, tree] : chunks.coords) {
+    tree->clearDirtyRegions();
+    for (int region = 0; region < REGIONS * REGIONS * REGIONS; region++)
+      chunks.buffer.setQuads(coord, region, chunks.mesh(coord, region));
+  }
+
+  chunks.buffer.flush();
+  EXPECT(Published(chunks, {{-1, 0, 0}, {0, 0, 0}, {1, 0, 0}}));
+
+  SparseVoxelOctree *center = chunks.coords.at({0, 0, 0});
+
+  // Inside a region, only it is meshed again.
+  center->setNeighbours({0, 0, 0}, chunks.coords);
+  center->set(10, 69, 10, 2);
+
+  EXPECT(chunks.meshDirty() == 1);
+  EXPECT(Published(chunks, {{0, 0, 0}}));
+
+  // On the +x border of the chunk and the z border of two regions, the
+  // voxels across them are uncovered, the regions they are in and the one
+  // in the next chunk are meshed again too.
+  center->set(127, 69, 64, EMPTY_VOXEL);
+
+  EXPECT(chunks.meshDirty() == 3);
+  EXPECT(Published(chunks, {{0, 0, 0}, {1, 0, 0}}));
+
+  // Without an edit nothing is meshed or published.
+  EXPECT(chunks.meshDirty() == 0);
+  EXPECT(Published(chunks, {}));
+}
+
+int main() {
+  TestEdit();
+
+  return Test::Result();
+}